@@ -179,11 +179,29 @@ namespace vxr
       .set_texture(texture_)
       .set_data(tex_data_);
     Engine::ref().submitDisplayList(std::move(frame));
+
+    // 15. The material setup and the draw never change, so they are recorded once in a retained display 
+    // list. This time, all the buffers and textures need to be set as parameters, with the number of 
+    // instances to be rendered in the render command.
+    DisplayList& commands = retained_commands_.record();
+    commands.setupMaterialCommand()
+      .set_material(material_)
+      .set_buffer(0, vertex_buffer_)
+      .set_buffer(1, instance_positions_buffer_)
+      .set_buffer(2, instance_colors_buffer_)
+      .set_uniform_buffer(0, uniform_buffer_)
+      .set_texture(0, texture_);
+    commands.renderCommand()
+      .set_index_buffer(index_buffer_)
+      .set_count(sizeof(index_data) / sizeof(uint16))
+      .set_type(IndexFormat::UInt16)
+      .set_instances(kNUM_INSTANCES);
+    retained_commands_.finish();
   }
 
   void Main::update(float dt)
   {
-    // 15. Update instances position. This operations are performed in the update() instead of the renderUpdate() for them to take into account deltaTime() and be framerate independent.
+    // 16. Update instances position. This operations are performed in the update() instead of the renderUpdate() for them to take into account deltaTime() and be framerate independent.
     static float v = 0;
     for (int i = 0; i < kNUM_INSTANCES; ++i)
     {
@@ -204,25 +222,13 @@ namespace vxr
     DisplayList frame;
     frame.clearCommand()
       .set_color({ 0.1f, 0.1f, 0.1f, 1.0f });
-    // 16. Re-upload instance position data to the GPU once each frame.
+    // 17. Re-upload instance position data to the GPU once each frame.
     frame.fillBufferCommand()
       .set_buffer(instance_positions_buffer_)
       .set_data(instance_positions_)
       .set_size(sizeof(instance_positions_));
-    // 17. Setup material for rendering. This time, all the buffers and textures need to be set as parameters.
-    frame.setupMaterialCommand()
-      .set_material(material_)
-      .set_buffer(0, vertex_buffer_)
-      .set_buffer(1, instance_positions_buffer_)
-      .set_buffer(2, instance_colors_buffer_)
-      .set_uniform_buffer(0, uniform_buffer_)
-      .set_texture(0, texture_);
-    // 18. Add render command with the number of instances to be rendered.
-    frame.renderCommand()
-      .set_index_buffer(index_buffer_)
-      .set_count(sizeof(index_data) / sizeof(uint16))
-      .set_type(IndexFormat::UInt16)
-      .set_instances(kNUM_INSTANCES);
+    // 18. Reference the retained commands recorded on start, instead of building them again.
+    frame.retainedCommand(retained_commands_);
     Engine::ref().submitDisplayList(std::move(frame));
 
     Application::renderUpdate();
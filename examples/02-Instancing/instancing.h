@@ -25,6 +25,7 @@
 // ----------------------------------------------------------------------------------------
 
 #include "../../include/engine/application.h"
+#include "../../include/graphics/retained_display_list.h"
 
 /**
 * \file instancing.h
@@ -57,6 +58,8 @@ namespace vxr
     gpu::Material material_;
     gpu::Texture texture_;
 
+    RetainedDisplayList retained_commands_;
+
     void* tex_data_;
 
     static const uint32 kNUM_INSTANCES = 40000;
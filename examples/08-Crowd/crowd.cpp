@@ -0,0 +1,139 @@
+// ----------------------------------------------------------------------------------------
+// MIT License
+// 
+// Copyright(c) 2018 Vctor vila
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ----------------------------------------------------------------------------------------
+
+#include "crowd.h"
+
+#include <stdlib.h>
+
+// 0. Define the entry point, the first argument is the number of worker threads.
+int runCrowd(int argc, char** argv)
+{
+  vxr::Main app((argc > 1) ? (vxr::uint32)atoi(argv[1]) : 0);
+  return app.run(argc, argv);
+}
+VXR_DEFINE_MAIN(runCrowd)
+
+namespace vxr
+{
+
+  Main::Main(uint32 max_running_threads) :
+    max_running_threads_(max_running_threads)
+  {
+    // 1. Initialize GPU, Window and Scheduler parameters.
+    Params p;
+    p.gpu = { 100, 100, 100, 100 };
+    p.window = { { 1280, 720 } };
+    p.scheduler.max_running_threads = max_running_threads;
+    Engine::ref().set_preinit_params(p);
+  }
+
+  void Main::start()
+  {
+    // 2. Create a Scene with a camera and a directional light.
+    ref_ptr<Scene> scene_;
+    scene_.alloc()->set_name("Crowd Scene");
+    Engine::ref().loadScene(scene_);
+
+    cam_.alloc()->set_name("Camera");
+    cam_->addComponent<Camera>()->transform()->set_local_position(vec3(0.0f, 60.0f, 160.0f));
+    cam_->transform()->set_local_rotation(vec3(-25.0f, 0.0f, 0.0f));
+    cam_->getComponent<Camera>()->set_background_color(Color::PhyreBlue);
+    scene_->addObject(cam_);
+
+    light_.alloc()->set_name("Sun");
+    light_->addComponent<Light>()->set_type(Light::Type::Directional);
+    light_->getComponent<Light>()->set_color(Color::White);
+    light_->transform()->set_local_rotation(vec3(2.34f, -0.2f, -1.0f));
+    scene_->addObject(light_);
+
+    // 3. Share a few materials and the default cube between every renderer.
+    static const uint32 kNumMaterials = 4;
+    const Color colors[kNumMaterials] = { Color::Red, Color::ClearWater, Color::CornSilk, Color::White };
+    ref_ptr<mat::Std::Instance> materials[kNumMaterials];
+    for (uint32 i = 0; i < kNumMaterials; ++i)
+    {
+      materials[i].alloc();
+      materials[i]->set_albedo(colors[i]);
+      materials[i]->set_metallic((float)i / kNumMaterials);
+      materials[i]->set_roughness(0.5f);
+    }
+    ref_ptr<Mesh> cube = Engine::ref().assetManager()->default_cube();
+
+    // 4. Lay the groups out in a grid, each one a 10x10 grid of cubes around its pivot.
+    const uint32 groups_per_row = 25;
+    for (uint32 g = 0; g < kNumGroups; ++g)
+    {
+      ref_ptr<GameObject> group;
+      group.alloc()->set_name("Group " + std::to_string(g));
+      group->transform()->set_local_position(vec3(((float)(g % groups_per_row) - groups_per_row * 0.5f) * 12.0f, 0.0f, -(float)(g / groups_per_row) * 12.0f));
+      scene_->addObject(group);
+
+      for (uint32 r = 0; r < kRenderersPerGroup; ++r)
+      {
+        ref_ptr<GameObject> obj;
+        obj.alloc();
+        obj->transform()->set_parent(group->transform());
+        obj->transform()->set_local_position(vec3((float)(r % 10) - 4.5f, 0.0f, (float)(r / 10) - 4.5f));
+        obj->transform()->set_local_scale(0.4f);
+        obj->addComponent<Renderer>()->material = materials[(g + r) % kNumMaterials].get();
+        obj->addComponent<MeshFilter>()->mesh = cube;
+      }
+      groups_.push_back(group);
+    }
+
+    fprintf(stdout, "[CROWD] %u renderers, max running threads %u (0 uses every hardware thread).\n", kNumGroups * kRenderersPerGroup, max_running_threads_);
+    Application::start();
+  }
+
+  void Main::update(float dt)
+  {
+    // 5. Rotate every group, which moves all the renderers of the scene.
+    for (uint32 g = 0; g < kNumGroups; ++g)
+    {
+      groups_[g]->transform()->rotateY((g % 2) ? 20.0f * dt : -20.0f * dt);
+    }
+
+    Application::update(dt);
+  }
+
+  void Main::renderUpdate()
+  {
+    // 6. Time the render update (transformations, culling and draw capture) and report the averages.
+    double start = Engine::ref().window()->uptime();
+    Application::renderUpdate();
+    double now = Engine::ref().window()->uptime();
+    render_update_time_ += now - start;
+
+    if (++frames_ == kReportFrames)
+    {
+      fprintf(stdout, "[CROWD] Frame %.3f ms, render update %.3f ms (average of %u frames).\n",
+        (now - last_report_time_) * 1000.0 / frames_, render_update_time_ * 1000.0 / frames_, frames_);
+      fflush(stdout);
+      last_report_time_ = now;
+      render_update_time_ = 0.0;
+      frames_ = 0;
+    }
+  }
+
+} /* end of vxr namespace */
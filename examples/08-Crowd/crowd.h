@@ -0,0 +1,75 @@
+#pragma once
+
+// ----------------------------------------------------------------------------------------
+// MIT License
+// 
+// Copyright(c) 2018 Vctor vila
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ----------------------------------------------------------------------------------------
+
+#include "../../include/engine/application.h"
+#include "../../include/engine/core_minimal.h"
+
+/**
+* \file crowd.h
+*
+* \author Victor Avila (avilapa.github.io)
+*
+* \brief This example stresses the engine systems with a scene of 50000 renderers.
+*
+* The renderers are split in groups rotating around their own pivot, so every transformation of the
+* scene changes each logic step. The number of worker threads (Params::scheduler) can be passed as the
+* first argument, 0 (default) uses every hardware thread. Average frame and render update times are
+* printed periodically, to measure how the update scales with the number of workers.
+*
+*/
+namespace vxr
+{
+
+  class Main : public Application
+  {
+
+    VXR_OBJECT(Main, Application);
+
+  public:
+    Main(uint32 max_running_threads = 0);
+
+    virtual void start() override;
+    virtual void update(float dt) override;
+    virtual void renderUpdate() override;
+
+  private:
+    static const uint32 kNumGroups = 500;
+    static const uint32 kRenderersPerGroup = 100;
+    static const uint32 kReportFrames = 300;
+
+    uint32 max_running_threads_;
+
+    ref_ptr<GameObject> cam_;
+    ref_ptr<GameObject> light_;
+    std::vector<ref_ptr<GameObject>> groups_;
+
+    // Accumulated since the last report.
+    double last_report_time_ = 0.0;
+    double render_update_time_ = 0.0;
+    uint32 frames_ = 0;
+  };
+
+} /* end of vxr namespace */
@@ -0,0 +1,236 @@
+// ----------------------------------------------------------------------------------------
+// MIT License
+// 
+// Copyright(c) 2018 Vctor vila
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ----------------------------------------------------------------------------------------
+
+#include "../../include/engine/application.h"
+#include "../../include/graphics/frustum.h"
+#include "../../include/graphics/occlusion.h"
+
+#include <algorithm>
+#include <random>
+
+/**
+* \file culling.cpp
+*
+* \author Victor Avila (avilapa.github.io)
+*
+* \brief This example checks the frustum and occlusion culling of the engine without a window. Known
+* scenes are culled with both the SIMD and the scalar paths (see FrustumCuller::set_simd() and
+* OcclusionBuffer::set_simd()), and random ones are compared between them. Returns 1 if any check fails.
+*
+*/
+namespace vxr
+{
+
+  static const uint32 kWidth = 320;
+  static const uint32 kHeight = 180;
+  static const uint32 kNumRandomBoxes = 4000;
+  static const uint32 kNumRandomOccluders = 40;
+
+  static bool Check(bool condition, const char* path, const char* description)
+  {
+    if (!condition)
+    {
+      fprintf(stdout, "[CULLING] FAILED (%s): %s\n", path, description);
+    }
+    return condition;
+  }
+
+  static mat4 ViewProjection()
+  {
+    // Camera at the origin looking down -Z.
+    return glm::perspective(glm::radians(60.0f), (float)kWidth / kHeight, 0.1f, 100.0f) *
+      glm::lookAt(vec3(0.0f), vec3(0.0f, 0.0f, -1.0f), vec3(0.0f, 1.0f, 0.0f));
+  }
+
+  static bool CheckFrustum(bool simd)
+  {
+    const char* path = simd ? "SIMD" : "scalar";
+    Frustum frustum;
+    frustum.set(ViewProjection());
+
+    // 1. Known boxes, not a multiple of 4 so the padding of the last batch is culled too.
+    struct Box { vec3 center; vec3 extents; bool visible; const char* description; };
+    const Box boxes[] = {
+      { vec3(0.0f, 0.0f, -10.0f), vec3(1.0f), true, "box in front of the camera is visible" },
+      { vec3(0.0f, 0.0f, 10.0f), vec3(1.0f), false, "box behind the camera is culled" },
+      { vec3(-50.0f, 0.0f, -10.0f), vec3(1.0f), false, "box left of the frustum is culled" },
+      { vec3(0.0f, 0.0f, -150.0f), vec3(1.0f), false, "box beyond the far plane is culled" },
+      { vec3(10.5f, 0.0f, -10.0f), vec3(1.0f), true, "box crossing the right plane is visible" },
+      { vec3(0.0f, 30.0f, -10.0f), vec3(1.0f), false, "box above the frustum is culled" },
+      { vec3(0.0f, 0.0f, -100.5f), vec3(1.0f), true, "box crossing the far plane is visible" },
+      { vec3(2.0f, 1.0f, -50.0f), vec3(0.1f), true, "small box inside the frustum is visible" },
+      { vec3(30.0f, 0.0f, -10.0f), vec3(1.0f), false, "box right of the frustum is culled" },
+    };
+    const uint32 num_boxes = sizeof(boxes) / sizeof(boxes[0]);
+
+    FrustumCuller culler;
+    culler.set_simd(simd);
+    for (uint32 i = 0; i < num_boxes; ++i)
+    {
+      culler.add(boxes[i].center, boxes[i].extents);
+    }
+    std::vector<uint32> visible;
+    culler.cull(frustum, &visible);
+
+    bool ok = Check(std::is_sorted(visible.begin(), visible.end()), path, "visible boxes are in insertion order");
+    for (uint32 i = 0; i < num_boxes; ++i)
+    {
+      const bool is_visible = std::find(visible.begin(), visible.end(), i) != visible.end();
+      ok &= Check(is_visible == boxes[i].visible, path, boxes[i].description);
+    }
+
+    // 2. Random boxes must match Frustum::test(), except the ones touching a plane which may round
+    // differently.
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> position(-120.0f, 120.0f), size(0.1f, 5.0f);
+    std::vector<vec3> centers, extents;
+    culler.clear();
+    for (uint32 i = 0; i < kNumRandomBoxes; ++i)
+    {
+      centers.push_back(vec3(position(rng), position(rng), position(rng) * 0.5f - 60.0f));
+      extents.push_back(vec3(size(rng), size(rng), size(rng)));
+      culler.add(centers.back(), extents.back());
+    }
+    visible.clear();
+    culler.cull(frustum, &visible);
+
+    uint32 mismatches = 0;
+    for (uint32 i = 0, v = 0; i < kNumRandomBoxes; ++i)
+    {
+      const bool is_visible = (v < visible.size() && visible[v] == i);
+      v += is_visible ? 1 : 0;
+      if (is_visible == frustum.test(centers[i], extents[i]))
+      {
+        continue;
+      }
+      float distance = FLT_MAX;
+      for (uint32 p = 0; p < 6; ++p)
+      {
+        const vec4& plane = frustum.plane(p);
+        distance = glm::min(distance, glm::abs(glm::dot(vec3(plane), centers[i]) + plane.w + glm::dot(glm::abs(vec3(plane)), extents[i])));
+      }
+      mismatches += (distance > 1e-3f) ? 1 : 0;
+    }
+    ok &= Check(mismatches == 0, path, "random boxes match Frustum::test()");
+    return ok;
+  }
+
+  static void Rasterize(OcclusionBuffer* buffer)
+  {
+    for (uint32 band = 0; band < buffer->num_bands(); ++band)
+    {
+      buffer->rasterize(band);
+    }
+  }
+
+  static bool CheckOcclusion(bool simd)
+  {
+    const char* path = simd ? "SIMD" : "scalar";
+
+    // 1. A 4x4 quad facing the camera 10 units in front of it, its shadow is 8x8 at 20 units.
+    OcclusionBuffer buffer;
+    buffer.set_simd(simd);
+    buffer.resize(kWidth, kHeight);
+    buffer.begin(ViewProjection());
+    const std::vector<vec3> quad = { vec3(-2.0f, -2.0f, 0.0f), vec3(2.0f, -2.0f, 0.0f), vec3(2.0f, 2.0f, 0.0f), vec3(-2.0f, 2.0f, 0.0f) };
+    const std::vector<uint32> indices = { 0, 1, 2, 0, 2, 3 };
+    buffer.addOccluder(glm::translate(mat4(1.0f), vec3(0.0f, 0.0f, -10.0f)), quad, indices);
+    Rasterize(&buffer);
+
+    bool ok = Check(buffer.num_triangles() == 2, path, "both triangles of the quad are front facing");
+    ok &= Check(buffer.occluded(vec3(0.0f, 0.0f, -20.0f), vec3(0.5f)), path, "box behind the quad is occluded");
+    ok &= Check(buffer.occluded(vec3(1.0f, -1.0f, -40.0f), vec3(2.0f)), path, "large box far behind the quad is occluded");
+    ok &= Check(!buffer.occluded(vec3(8.0f, 0.0f, -20.0f), vec3(0.5f)), path, "box beside the quad is visible");
+    ok &= Check(!buffer.occluded(vec3(3.8f, 0.0f, -20.0f), vec3(1.0f)), path, "box partially beside the quad is visible");
+    ok &= Check(!buffer.occluded(vec3(0.0f, 0.0f, -5.0f), vec3(0.5f)), path, "box in front of the quad is visible");
+    ok &= Check(!buffer.occluded(vec3(0.0f, 0.0f, -10.0f), vec3(0.5f)), path, "box crossing the quad is visible");
+
+    // 2. The back of the quad does not occlude.
+    buffer.begin(ViewProjection());
+    const std::vector<uint32> back = { 0, 2, 1, 0, 3, 2 };
+    buffer.addOccluder(glm::translate(mat4(1.0f), vec3(0.0f, 0.0f, -10.0f)), quad, back);
+    Rasterize(&buffer);
+    ok &= Check(buffer.num_triangles() == 0, path, "back facing triangles are dropped");
+    ok &= Check(!buffer.occluded(vec3(0.0f, 0.0f, -20.0f), vec3(0.5f)), path, "box behind a back facing quad is visible");
+    return ok;
+  }
+
+  static bool CompareOcclusion()
+  {
+    // Random occluders and boxes must give the same results on both paths.
+    std::mt19937 rng(4321);
+    std::uniform_real_distribution<float> position(-15.0f, 15.0f), depth(-60.0f, -2.0f), size(0.2f, 6.0f), angle(-3.14f, 3.14f);
+    const std::vector<vec3> quad = { vec3(-1.0f, -1.0f, 0.0f), vec3(1.0f, -1.0f, 0.0f), vec3(1.0f, 1.0f, 0.0f), vec3(-1.0f, 1.0f, 0.0f) };
+    const std::vector<uint32> indices = { 0, 1, 2, 0, 2, 3 };
+
+    OcclusionBuffer buffers[2];
+    for (uint32 i = 0; i < 2; ++i)
+    {
+      buffers[i].set_simd(i == 0);
+      buffers[i].resize(kWidth, kHeight);
+      buffers[i].begin(ViewProjection());
+    }
+    for (uint32 o = 0; o < kNumRandomOccluders; ++o)
+    {
+      const mat4 model = glm::translate(mat4(1.0f), vec3(position(rng), position(rng), depth(rng))) *
+        glm::rotate(mat4(1.0f), angle(rng), vec3(0.0f, 0.0f, 1.0f)) * glm::rotate(mat4(1.0f), angle(rng) * 0.3f, vec3(1.0f, 0.0f, 0.0f)) *
+        glm::scale(mat4(1.0f), vec3(size(rng), size(rng), 1.0f));
+      buffers[0].addOccluder(model, quad, indices);
+      buffers[1].addOccluder(model, quad, indices);
+    }
+    Rasterize(&buffers[0]);
+    Rasterize(&buffers[1]);
+
+    uint32 mismatches = 0, occluded = 0;
+    for (uint32 i = 0; i < kNumRandomBoxes; ++i)
+    {
+      const vec3 center = vec3(position(rng), position(rng), depth(rng) - 10.0f);
+      const vec3 extents = vec3(size(rng)) * 0.2f;
+      const bool result = buffers[0].occluded(center, extents);
+      mismatches += (result != buffers[1].occluded(center, extents)) ? 1 : 0;
+      occluded += result ? 1 : 0;
+    }
+    fprintf(stdout, "[CULLING] %u of %u random boxes occluded by %u triangles.\n", occluded, kNumRandomBoxes, buffers[0].num_triangles());
+    return Check(mismatches == 0 && occluded > 0, "SIMD and scalar", "random boxes are occluded the same on both paths");
+  }
+
+} /* end of vxr namespace */
+
+// 0. Define the entry point, no application is needed.
+int runCullingChecks(int, char**)
+{
+  bool ok = true;
+  for (vxr::uint32 simd = 0; simd < 2; ++simd)
+  {
+    ok &= vxr::CheckFrustum(simd != 0);
+    ok &= vxr::CheckOcclusion(simd != 0);
+  }
+  ok &= vxr::CompareOcclusion();
+#if !VXR_SIMD
+  fprintf(stdout, "[CULLING] Built without VXR_SIMD, both paths are scalar.\n");
+#endif
+  fprintf(stdout, "[CULLING] %s\n", ok ? "All checks passed." : "Some checks failed.");
+  return ok ? 0 : 1;
+}
+VXR_DEFINE_MAIN(runCullingChecks)
@@ -0,0 +1,159 @@
+// ----------------------------------------------------------------------------------------
+// MIT License
+// 
+// Copyright(c) 2018 Vctor vila
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ----------------------------------------------------------------------------------------
+
+#include "../../include/engine/application.h"
+#include "../../include/utils/math.h"
+
+#include <chrono>
+#include <random>
+
+/**
+* \file transforms.cpp
+*
+* \author Victor Avila (avilapa.github.io)
+*
+* \brief This example times the composition of world matrices without a window: the glm path of
+* Transform::local_transform() against Math::composeTransforms(), with both its SIMD and its scalar
+* paths. Both paths must match the glm one, returns 1 otherwise.
+*
+*/
+namespace vxr
+{
+
+  // Not a multiple of 4, so the remainder of the SIMD path is composed too.
+  static const uint32 kNumTransforms = 65537;
+  static const uint32 kNumIterations = 50;
+  static const float kTolerance = 1e-4f;
+
+  struct Transforms
+  {
+    std::vector<vec3> positions;
+    std::vector<quat> rotations;
+    std::vector<vec3> scales;
+    std::vector<mat4> parent_matrices;
+    std::vector<const mat4*> parents;
+  };
+
+  static void Generate(Transforms* t)
+  {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f), unit(-1.0f, 1.0f), scale(0.1f, 4.0f);
+
+    // A few parents shared by every transform, the first one identity as for roots.
+    t->parent_matrices.push_back(mat4(1.0f));
+    for (uint32 i = 1; i < 16; ++i)
+    {
+      const quat rotation = glm::normalize(quat(unit(rng), unit(rng), unit(rng), unit(rng)));
+      t->parent_matrices.push_back(glm::translate(vec3(position(rng), position(rng), position(rng))) *
+        glm::scale(vec3(scale(rng), scale(rng), scale(rng))) * glm::toMat4(rotation));
+    }
+    for (uint32 i = 0; i < kNumTransforms; ++i)
+    {
+      t->positions.push_back(vec3(position(rng), position(rng), position(rng)));
+      t->rotations.push_back(glm::normalize(quat(unit(rng), unit(rng), unit(rng), unit(rng))));
+      t->scales.push_back(vec3(scale(rng), scale(rng), scale(rng)));
+      t->parents.push_back(&t->parent_matrices[i % t->parent_matrices.size()]);
+    }
+  }
+
+  static void ComposeGLM(const Transforms& t, mat4* out)
+  {
+    for (uint32 i = 0; i < kNumTransforms; ++i)
+    {
+      out[i] = *t.parents[i] * (glm::translate(t.positions[i]) * glm::scale(t.scales[i]) * glm::toMat4(t.rotations[i]));
+    }
+  }
+
+  static void ComposeMath(const Transforms& t, mat4* out, bool simd)
+  {
+    Math::composeTransforms(kNumTransforms, t.positions.data(), t.rotations.data(), t.scales.data(), t.parents.data(), out, simd);
+  }
+
+  // Average time of a composition of every transform, in milliseconds.
+  template<typename F>
+  static double Time(F compose)
+  {
+    compose();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32 i = 0; i < kNumIterations; ++i)
+    {
+      compose();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / kNumIterations;
+  }
+
+  static bool Check(const std::vector<mat4>& reference, const std::vector<mat4>& result, const char* path)
+  {
+    uint32 mismatches = 0;
+    float max_error = 0.0f;
+    for (uint32 i = 0; i < kNumTransforms; ++i)
+    {
+      for (uint32 c = 0; c < 4; ++c)
+      {
+        for (uint32 r = 0; r < 4; ++r)
+        {
+          const float error = glm::abs(reference[i][c][r] - result[i][c][r]) / glm::max(1.0f, glm::abs(reference[i][c][r]));
+          max_error = glm::max(max_error, error);
+          mismatches += (error > kTolerance) ? 1 : 0;
+        }
+      }
+    }
+    fprintf(stdout, "[TRANSFORMS] %s path: max relative error %g.\n", path, max_error);
+    if (mismatches)
+    {
+      fprintf(stdout, "[TRANSFORMS] FAILED (%s): %u values do not match glm.\n", path, mismatches);
+    }
+    return mismatches == 0;
+  }
+
+} /* end of vxr namespace */
+
+// 0. Define the entry point, no application is needed.
+int runTransformBenchmark(int, char**)
+{
+  using namespace vxr;
+
+  Transforms t;
+  Generate(&t);
+  std::vector<mat4> reference(kNumTransforms), simd(kNumTransforms), scalar(kNumTransforms);
+
+  const double glm_time = Time([&]() { ComposeGLM(t, reference.data()); });
+  const double simd_time = Time([&]() { ComposeMath(t, simd.data(), true); });
+  const double scalar_time = Time([&]() { ComposeMath(t, scalar.data(), false); });
+
+  bool ok = Check(reference, simd, "SIMD");
+  ok &= Check(reference, scalar, "scalar");
+
+#if !VXR_SIMD
+  fprintf(stdout, "[TRANSFORMS] Built without VXR_SIMD, both paths are scalar.\n");
+#endif
+  fprintf(stdout, "[TRANSFORMS] %u transforms, average of %u iterations:\n", kNumTransforms, kNumIterations);
+  fprintf(stdout, "[TRANSFORMS]   glm    %.3f ms\n", glm_time);
+  fprintf(stdout, "[TRANSFORMS]   SIMD   %.3f ms (%.2fx)\n", simd_time, glm_time / simd_time);
+  fprintf(stdout, "[TRANSFORMS]   scalar %.3f ms (%.2fx)\n", scalar_time, glm_time / scalar_time);
+  fprintf(stdout, "[TRANSFORMS] %s\n", ok ? "Both paths match glm." : "Some checks failed.");
+  return ok ? 0 : 1;
+}
+VXR_DEFINE_MAIN(runTransformBenchmark)
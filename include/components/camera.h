@@ -47,6 +47,7 @@ namespace vxr
 	class Camera : public Component
   {
     VXR_OBJECT(Camera, Component);
+    friend class System::Camera;
 	public:
     Camera();
 		~Camera();
@@ -83,6 +84,12 @@ namespace vxr
     PROPERTY(bool, clear_color_, clear_color, true);
     PROPERTY(bool, clear_depth_, clear_depth, true);
     PROPERTY(bool, clear_stencil_, clear_stencil, true);
+
+    // Opaque renderers are first drawn depth-only, then shaded with an Equal depth test, so that expensive
+    // materials only shade the visible pixels.
+    PROPERTY(bool, depth_prepass_, depth_prepass, false);
+    // Opaque renderers are drawn strictly front-to-back instead of grouped by program first.
+    PROPERTY(bool, front_to_back_, front_to_back, false);
 #undef PROPERTY
 
     void set_clear_flags(ClearFlags::Enum flags);
@@ -101,6 +108,8 @@ namespace vxr
 
   private:
     bool dirty_ = true;     
+    // Render version of the transform the view was computed from, see Transform::render_version().
+    uint32 transform_version_ = 0;
     ClearFlags::Enum clear_flags_ = ClearFlags::SolidColor;
 
     ref_ptr<Composer> composer_;
@@ -27,6 +27,7 @@
 #include "../core/component.h"
 #include "../graphics/materials/shader.h"
 #include "../graphics/gpu_resources.h"
+#include "../graphics/light_clusters.h"
 
 /**
 * \file light.h
@@ -67,6 +68,12 @@ namespace vxr
 
 	private:
     bool contributes_;
+    // Incremented every time a property changes.
+    uint32 version_ = 0;
+    // Slot of the light in the light data, and the sources its current data was packed from.
+    int32 slot_ = -1;
+    uint32 packed_version_ = 0;
+    uint32 packed_transform_version_ = 0;
 
     Type::Enum type_;
     Color color_;
@@ -87,18 +94,79 @@ namespace vxr
 
       void init() override;
       void renderPreUpdate() override;
+      // Bins the punctual lights into the clusters of the main camera, once its matrices are up to date.
+      void renderUpdate() override;
 
       uint32 num_lights() const;
+      // One past the last slot in use of the light data, free slots in between have no contribution.
+      uint32 num_light_slots() const;
       gpu::Buffer light_uniforms_buffer() const;
+      // Light lists of the view space clusters read by the lighting shaders, see LightClusters.
+      gpu::Buffer light_clusters_buffer() const;
+      gpu::Buffer light_indices_buffer() const;
 
     private:
+      // Light data gathered by one chunk of components on the scheduler workers. Only filled when the light
+      // changed since it was last packed or has no slot yet.
+      struct Source
+      {
+        uint32 component;
+        bool changed;
+        vec4 position_falloff;
+        vec4 color_intensity;
+        vec4 direction_ambient;
+      };
+
+      struct Chunk
+      {
+        std::vector<Source> sources;
+        // Lights with a transform to be updated, gathered on the calling thread (see gather()).
+        std::vector<uint32> deferred;
+      };
+
+      void gather(uint32 chunk);
+      Source source(uint32 component);
+      bool owns(const vxr::Light* c) const;
+      // Copies the source into the slot of its light, or clears a released slot.
+      void pack(uint32 slot, const Source& s);
+      void release(uint32 slot);
+
       uint32 num_lights_ = 0;
+      uint32 num_slots_ = 0;
+      uint32 scene_id_ = 0;
+      std::vector<Chunk> chunks_;
+
+      // Lights keep their slot until they stop contributing, new lights take the first free one.
+      vxr::Light* slot_owner_[kMaxLightSources] = {};
+      uint32 slot_frame_[kMaxLightSources] = {};
+      uint32 frame_ = 0;
+      // Lights without a slot, given one once the slots of the lights gone have been released.
+      std::vector<Source> pending_;
+      // Range of slots changed since the last upload.
+      uint32 dirty_begin_ = 0;
+      uint32 dirty_end_ = 0;
+      // Slots of the directional lights, evaluated by every fragment, and of the punctual ones, binned into clusters.
+      std::vector<uint8> directional_;
+      std::vector<uint8> punctual_;
 
       struct LightUniforms
       {
         gpu::Buffer buffer;
         Shader::LightData data;
       } light_uniforms_;
+
+      LightClusters clusters_;
+      bool clusters_overflow_ = false;
+      struct ClusterUniforms
+      {
+        gpu::Buffer buffer;
+        Shader::LightClusterData data;
+      } cluster_uniforms_;
+      struct IndexUniforms
+      {
+        gpu::Buffer buffer;
+        Shader::LightIndexData data;
+      } index_uniforms_;
     };
 
     template<> class Getter<vxr::Light>
@@ -26,6 +26,7 @@
 
 #include "../core/component.h"
 #include "../graphics/mesh.h"
+#include "../graphics/mesh_lod.h"
 
 /**
 * \file mesh_filter.h
@@ -48,6 +49,8 @@ namespace vxr
     virtual void onGUI() override;
 
     ref_ptr<Mesh> mesh;
+    // Optional simplified versions of 'mesh' (its source), drawn depending on their size on screen.
+    ref_ptr<MeshLOD> lod;
 	};
 
   namespace System 
@@ -26,6 +26,14 @@
 
 #include "../core/component.h"
 #include "../graphics/materials/material_instance.h"
+#include "../graphics/gpu_resources.h"
+#include "../graphics/render_bucket.h"
+#include "../graphics/frustum.h"
+#include "../graphics/mesh_lod.h"
+#include "../graphics/occlusion.h"
+#include "../graphics/retained_display_list.h"
+
+#include <unordered_map>
 
 /**
 * \file renderer.h
@@ -48,9 +56,15 @@ namespace vxr
     virtual void onGUI() override;
 
     ref_ptr<mat::MaterialInstance> material;
+    // Occluders are drawn into the CPU occlusion buffer (few, large and simple meshes work best),
+    // occludees are not drawn while hidden behind them.
+    bool occluder = false;
+    bool occludee = true;
 	};
 
   class DisplayList;
+  class MeshFilter;
+  class Mesh;
 
   namespace System 
   {
@@ -64,15 +78,191 @@ namespace vxr
       void renderUpdate() override;
       void renderPostUpdate() override;
 
+      // Renderers set up last frame that were inside and outside the main camera frustum.
+      uint32 num_visible() const;
+      uint32 num_culled() const;
+      // Renderers inside the frustum hidden behind the occluders.
+      uint32 num_occluded() const;
+
     private:
-      bool setup(ref_ptr<vxr::Renderer> c);
-      void render(ref_ptr<vxr::Renderer> c, DisplayList* frame);
+      // Cached plain copy of a Renderer, its MeshFilter and their resources, rebuilt only when any of
+      // them changes (see changed()), so that the per-frame loop does not touch the components.
+      struct Proxy
+      {
+        GameObject* object;
+        vxr::MeshFilter* mesh_filter;
+        mat::Material* shared_material;
+        // Identity and version of the sources the proxy was built from.
+        uint32 material_id;
+        uint32 material_version;
+        uint32 shared_material_version;
+        uint32 mesh_id;
+        uint32 mesh_version;
+        uint32 lod_id;
+        uint32 lod_version;
+        uint32 arena_generation;
+        bool valid;
+
+        gpu::Material material;
+        gpu::Material instanced_material;
+        gpu::Material equal_material;
+        gpu::Material equal_instanced_material;
+        Cull::Enum cull;
+        // Geometry of every level of detail of the mesh, level 0 is the mesh itself.
+        struct Geometry
+        {
+          gpu::Buffer vertex_buffer;
+          gpu::Buffer index_buffer;
+          uint32 index_count;
+          uint32 index_offset;
+          uint32 base_vertex;
+          IndexFormat::Enum index_format;
+          float screen_size;
+        } lods[MeshLOD::kMaxLevels];
+        uint32 num_lods;
+        // Level drawn last frame, only changes when the screen size crosses a threshold by some margin.
+        uint32 lod;
+        Bounds bounds;
+        const void* uniforms;
+        uint32 uniforms_size;
+        const char* uniforms_block;
+        uint32 num_textures;
+        gpu::Texture textures[kMaxTextureUnits];
+        // Instance textures, set up again when their data changes.
+        Texture* texture_sources[kMaxTextureUnits];
+        uint32 texture_set;
+        bool transparent;
+        bool occluder;
+        bool occludee;
+        // Coarsest level of detail, rasterized when the renderer is an opaque occluder.
+        const Mesh* occluder_mesh;
+        const mat4* world;
+        // World space box of the bounds, recomputed only when the render version of the transform changes.
+        const uint32* world_version;
+        uint32 bounds_version;
+        vec3 center;
+        vec3 extents;
+      };
+
+      // Plain copy of everything needed to record a draw, so that draws can be recorded in parallel.
+      struct Draw
+      {
+        gpu::Material material;
+        // Variant of the material drawing several instances at once, invalid if not supported.
+        gpu::Material instanced_material;
+        // Variants drawn after the depth pre-pass, invalid if the material can not use it.
+        gpu::Material equal_material;
+        gpu::Material equal_instanced_material;
+        Cull::Enum cull;
+        gpu::Buffer vertex_buffer;
+        gpu::Buffer index_buffer;
+        // Range of the per-frame draw uniforms buffer, size is 0 if the material has no uniforms.
+        // They are packed when the draw is queued, instanced draws pack them per instance instead.
+        const void* uniforms;
+        uint32 uniforms_offset;
+        uint32 uniforms_size;
+        const char* uniforms_block;
+        uint32 index_count;
+        // Byte offset of the first index and vertex added to the indices, see MeshArena.
+        uint32 index_offset;
+        uint32 base_vertex;
+        IndexFormat::Enum index_format;
+        uint32 num_textures;
+        gpu::Texture textures[kMaxTextureUnits];
+        uint32 texture_set;
+        mat4 model;
+        float depth;
+        bool transparent;
+        // Instanced draws read 'instances' Shader::InstanceData from the draw uniforms buffer.
+        uint32 instances;
+        uint32 instances_offset;
+      };
+
+      // Renderers are processed in chunks of proxies on the scheduler workers, each chunk with its own output.
+      struct Chunk
+      {
+        // Proxies whose sources changed, rebuilt on the calling thread.
+        std::vector<uint32> stale;
+        // Proxies ready to be drawn and the ones inside the frustum.
+        std::vector<uint32> candidates;
+        std::vector<uint32> visible;
+        uint32 num_candidates;
+        uint32 num_occluded;
+        FrustumCuller culler;
+        // Index of the first draw captured by the chunk.
+        uint32 first_draw;
+      };
+
+      // Checks and culls the proxies of a chunk, frustum is null if nothing has to be culled. Only reads
+      // plain data, so chunks run in parallel.
+      void prepare(uint32 chunk, const Frustum* frustum);
+      // Rasterizes the visible occluders and removes the hidden occludees from the visible lists.
+      void occlude(const mat4& view_projection, uint32 num_chunks);
+      bool changed(vxr::Renderer* c, const Proxy& proxy) const;
+      bool build(vxr::Renderer* c, Proxy* proxy);
+      // Picks the level of detail of the proxy and copies it into the draw.
+      void capture(Proxy* proxy, const vec3& eye, Draw* draw);
+      void queue(uint32 index, RenderBucket* bucket);
+      // Merges the opaque draws sharing mesh, material and textures into instanced draws.
+      void batch();
+      // Depth-only draws use the pre-pass program instead of the material.
+      void render(const Draw& draw, bool depth_only, DisplayList* frame);
+      void submit(const RenderBucket& bucket, bool depth_only);
+      // Trivial program writing the depth of the opaque draws with the given cull mode, created on first use.
+      gpu::Material prepassMaterial(Cull::Enum cull, bool instanced);
+      uint32 reserveUniforms(uint32 size);
+      uint32 packUniforms(const void* uniforms, uint32 size);
+      uint32 packInstances(const std::pair<uint64, uint32>* batch, uint32 count);
+      void uploadUniforms();
+
+      static uint64 BatchKey(const Draw& draw);
+      static bool SameBatch(const Draw& a, const Draw& b);
 
       bool setupSkybox();
       void renderSkybox();
 
     private:
-      std::vector<ref_ptr<vxr::Renderer>> transparent_;
+      // One proxy per component, in the same order as components_.
+      std::vector<Proxy> proxies_;
+
+      std::vector<Chunk> chunks_;
+      uint32 num_candidates_ = 0;
+      uint32 num_visible_ = 0;
+      uint32 num_occluded_ = 0;
+      OcclusionBuffer occlusion_;
+      // Read by the chunks instead of the scene and the mesh arena.
+      uint32 scene_id_ = 0;
+      uint32 arena_generation_ = 0;
+      // Last row of the view projection (clip space w) and vertical projection scale, used to compute the
+      // screen size of the proxies. Levels of detail are not used without a camera (scale 0).
+      vec4 lod_clip_w_ = vec4(0.0f);
+      float lod_scale_ = 0.0f;
+
+      std::vector<Draw> draws_;
+      // (BatchKey, draw index) of the opaque draws that can be instanced.
+      std::vector<std::pair<uint64, uint32>> batches_;
+      RenderBucket opaque_;
+      RenderBucket transparent_;
+      // Depth-only copies of the opaque draws that can use the pre-pass, sorted front-to-back.
+      RenderBucket prepass_;
+      // Main camera settings, see Camera::depth_prepass and Camera::front_to_back.
+      bool depth_prepass_ = false;
+      bool front_to_back_ = false;
+      gpu::Material prepass_materials_[3][2];
+
+      gpu::Buffer common_uniforms_buffer_;
+      gpu::Buffer light_uniforms_buffer_;
+      gpu::Buffer light_clusters_buffer_;
+      gpu::Buffer light_indices_buffer_;
+
+      // Uniforms of every material instance drawn this frame, packed at kUniformBufferAlignment 
+      // strides and uploaded at once. Too big to be copied to the frame, they are handed to the GPU
+      // (see GPU::releaseData()) and packed in new storage the next frame.
+      gpu::Buffer draw_uniforms_buffer_;
+      std::shared_ptr<std::vector<uint8>> draw_uniforms_;
+      std::unordered_map<const void*, uint32> draw_uniforms_offsets_;
+
+      RetainedDisplayList skybox_commands_;
     };
 
     template<> class Getter<vxr::Renderer>
@@ -114,7 +114,7 @@ namespace vxr
         uint32 scene_index_; 
       };
 
-      bool System::Rigidbody::aabbVsAabb(const AABB& a, const AABB& b);
+      bool aabbVsAabb(const AABB& a, const AABB& b);
       uint32 sorting_axis_ = 0;
 
       std::vector<ref_ptr<vxr::Rigidbody>> scene_components_;
@@ -31,7 +31,7 @@
 *
 * \author Victor Avila (avilapa.github.io)
 *
-* \brief Transform Component and Transform System classes. Transform Component contains the matrices for each GameObject as well as children hierarchy information. Transform System performs updates on its components when needed.
+* \brief Transform Component and Transform System classes. Transform Component is a handle to the local and world transformations of each GameObject, stored by the Transform System in arrays with the rest of the hierarchy. Transform System performs updates on its components when needed, one level of the hierarchy at a time.
 *
 */
 namespace vxr 
@@ -41,6 +41,7 @@ namespace vxr
 	class Transform : public Component
   {
     VXR_OBJECT(Transform, Component);
+    friend class System::Transform;
 	public:
     Transform();
 		~Transform();
@@ -110,6 +111,19 @@ namespace vxr
     vec3 world_up() const;
 
     mat4 world_transform() const;
+    // Stable address of the world matrix, brought up to date by the Transform System every frame.
+    const mat4* world_matrix() const;
+    // Incremented every time the world transformations are recomputed, so that consumers can compare it
+    // with the one they last read instead of relying on hasChanged(). Read it after the world values.
+    uint32 version() const;
+    // Stable address of the version, see world_matrix().
+    const uint32* version_counter() const;
+    // Stable address of the world matrix to draw, interpolated between the last two logic steps when the
+    // Transform System interpolates (see System::Transform::set_interpolation()), the world matrix otherwise.
+    const mat4* render_matrix() const;
+    // Incremented every time the render matrix changes, see version().
+    uint32 render_version() const;
+    const uint32* render_version_counter() const;
 
     /// TODO: Re parenting.
     void set_parent(ref_ptr<Transform> parent);
@@ -122,21 +136,13 @@ namespace vxr
     void markForUpdate() const;
     bool hasChanged() const;
 	private:
-    mutable bool dirty_ = true;
+    // Slot of the transform in the hierarchy arrays of the system.
+    System::Transform* system_;
+    uint32 id_;
 
     ref_ptr<Transform> parent_;
     std::vector<ref_ptr<Transform>> children_;
 
-    vec3 position_;
-    quat rotation_;
-    vec3 scale_;
-
-    mutable vec3 world_position_;
-    mutable quat world_rotation_;
-    mutable vec3 world_scale_;
-
-    mutable mat4 world_transform_;
-
     // Euler Angles is used internally just to display quaternions in UI properly.
     vec3 euler_angles_;
 	};
@@ -151,6 +157,89 @@ namespace vxr
       ~Transform();
 
       void renderUpdate() override;
+
+      // Render matrices are interpolated between the last two logic steps, so that logic can run at a lower
+      // rate than rendering with smooth motion, at the cost of up to a logic step of latency.
+      void set_interpolation(bool enabled);
+      bool interpolation() const;
+      // Keeps the local transformations of the last logic step, called before every step.
+      void snapshot();
+      // Fraction of a logic step elapsed since the last one, called before every render update.
+      void set_step_fraction(float fraction);
+
+      static const uint32 kNone = 0xFFFFFFFF;
+
+    private:
+      friend class vxr::Transform;
+
+      // Adds a root transform with identity transformations, returns its slot.
+      uint32 allocate();
+      // Moves the slot (and its subtree) under a new parent, kNone makes it a root.
+      void set_parent(uint32 id, uint32 parent);
+      // Marks the slot and its subtree as changed.
+      void markForUpdate(uint32 id);
+      // Brings the world transformations of a changed slot up to date, along with its changed ancestors.
+      void update(uint32 id);
+      // World transformations of a slot from the ones of its parent, which must be up to date.
+      void compute(uint32 id);
+      // Same for a batch of slots of the same level, see Math::composeTransforms().
+      void compute(const uint32* ids, uint32 count);
+      // Rest of the world transformations of a slot once its world matrix is up to date.
+      void finish(uint32 id);
+      // Lists a slot about to be updated for the next snapshot() when interpolating, for the next render
+      // update otherwise.
+      void record(uint32 id);
+      // Updates the changed slots level by level, and their render matrices if requested.
+      void updateLevels(bool render);
+      // Render matrices of a batch of slots of the same level from the interpolated local transformations.
+      void interpolate(const uint32* ids, uint32 count);
+      void setDepth(uint32 id, uint32 depth);
+      // Scratch stack of the hierarchy walks, which are iterative so deep hierarchies can not overflow.
+      std::vector<uint32> stack_;
+
+      // Hierarchy stored as structure of arrays indexed by slot. Slots never move, so world matrices
+      // can be referenced by address (see vxr::Transform::world_matrix()).
+      paged_array<vec3> position_;
+      paged_array<quat> rotation_;
+      paged_array<vec3> scale_;
+      paged_array<mat4> world_;
+      paged_array<vec3> world_position_;
+      paged_array<quat> world_rotation_;
+      paged_array<vec3> world_scale_;
+      paged_array<uint32> parent_;
+      paged_array<uint32> first_child_;
+      paged_array<uint32> next_sibling_;
+      paged_array<uint32> depth_;
+      // 1 once marked for update, 2 while queued in its level by updateLevels().
+      paged_array<uint8> dirty_;
+      paged_array<uint32> version_;
+      uint32 num_slots_ = 0;
+
+      // Local transformations at the last snapshot() and the version they were kept at, kNone if the slot
+      // has none yet (new or moved to another parent) and must not be interpolated.
+      paged_array<vec3> previous_position_;
+      paged_array<quat> previous_rotation_;
+      paged_array<vec3> previous_scale_;
+      paged_array<uint32> snapshot_version_;
+      // Render matrices, along with the version of the world matrix they were copied from (kNone if they
+      // were interpolated) and their own version.
+      paged_array<mat4> render_world_;
+      paged_array<uint32> render_source_;
+      paged_array<uint32> render_version_;
+      bool interpolation_ = false;
+      float step_fraction_ = 1.0f;
+
+      // Slots marked for update at each depth of the hierarchy, roots first. Levels are updated in order and
+      // the slots of a level in parallel, as they only read the world transformations of the previous one.
+      // Slots updated on demand or moved to another depth leave stale entries, skipped when updating.
+      std::vector<std::vector<uint32>> dirty_levels_;
+      // Slots updated since the last snapshot (interpolated every render update until then), and slots whose
+      // render matrix must be copied from their world matrix. listed_ flags them so they are listed once.
+      std::vector<uint32> step_slots_;
+      std::vector<uint32> render_slots_;
+      paged_array<uint8> listed_;
+      // Scratch lists of the render update, the slots to refresh at each depth.
+      std::vector<std::vector<uint32>> render_levels_;
     };
 
     template<> class Getter<vxr::Transform>
@@ -40,6 +40,7 @@ namespace vxr
   class GameObject;
   class Texture;
   class Mesh;
+  class MeshLOD;
   namespace mat { class Material; class MaterialInstance; class RenderPass; class RenderPassInstance; }
   namespace mesh { class Cube; class Quad; }
 
@@ -96,6 +97,8 @@ namespace vxr
 
     // Meshes
     ref_ptr<Mesh> loadMesh(const char* file, uint32 mesh_index = 0);
+    // Loads the mesh and generates its levels of detail once loaded, cached to '<file>.lod'.
+    ref_ptr<MeshLOD> loadMeshLOD(const char* file, uint32 mesh_index = 0);
 
     ref_ptr<Mesh> default_cube() const;
     ref_ptr<Mesh> default_quad() const;
@@ -114,6 +117,7 @@ namespace vxr
     std::vector<ref_ptr<mat::RenderPass>> render_passes_;
     std::vector<ref_ptr<Texture>> textures_;
     std::vector<ref_ptr<Mesh>> meshes_;
+    std::vector<ref_ptr<MeshLOD>> mesh_lods_;
 
     ref_ptr<Composer> default_composer_;
 	};
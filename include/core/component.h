@@ -104,7 +104,7 @@ namespace vxr
   }
 
 #define VXR_COMPONENT_SYSTEM(type_name, base_type_name)       \
-  VXR_OBJECT(System::##type_name, System::##base_type_name);  \
+  VXR_OBJECT(System::type_name, System::base_type_name);      \
   template<typename T> ref_ptr<T> createInstance()            \
   {                                                           \
     ref_ptr<T> c;                                             \
@@ -113,6 +113,6 @@ namespace vxr
     return c.get();                                           \
   }                                                           \
  private:                                                     \
-  std::vector<ref_ptr<vxr::##type_name>> components_;
+  std::vector<ref_ptr<vxr::type_name>> components_;
 
 } /* end of vxr namespace */
\ No newline at end of file
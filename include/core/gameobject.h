@@ -109,7 +109,7 @@ namespace vxr
           return other;
         }
       }
-      ref_ptr<T> component = System::Getter<L>::get()->createInstance<T>();
+      ref_ptr<T> component = System::Getter<L>::get()->template createInstance<T>();
       component->obj_ = this;
       component->transform_ = transform_;
       components_.push_back(component.get());
@@ -59,6 +59,8 @@ namespace vxr
 
     void set_time_step(double time_step);
     void set_max_steps(uint32 steps);
+    // Draws the transformations interpolated between the last two logic steps, see System::Transform::set_interpolation().
+    void set_render_interpolation(bool enabled);
 
     float deltaTime();
     uint32 fps();
@@ -72,6 +74,7 @@ namespace vxr
     {
       double time_step = (1.0 / 60.0);
       uint32 max_steps = 10;
+      bool interpolate = false;
       uint32 fps = 0;
     } framerate_;
   };
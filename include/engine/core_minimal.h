@@ -36,7 +36,7 @@
 // Engine
 // ----------------------------------------------------------------------------------------
 
-#include "../../include/engine/GPU.h"
+#include "../../include/engine/gpu.h"
 
 // ----------------------------------------------------------------------------------------
 // Components
@@ -72,7 +72,15 @@ namespace vxr
     bool is_exiting();
 
     void submitDisplayList(DisplayList &&dl);
+    /// Records 'num_chunks' display lists in parallel on the scheduler workers (record is called once per 
+    /// chunk with its own DisplayList) and submits them in chunk order. The record function must not submit 
+    /// display lists itself nor touch ref counted objects shared between chunks.
+    void submitParallelDisplayLists(uint32 num_chunks, std::function<void(uint32 chunk, DisplayList& dl)> record);
     void submitUIFunction(std::function<void()> function);
+    /// Calls 'job' once per index in [0, num_jobs) on the scheduler workers and returns when all of them 
+    /// have finished, runs them in order on the calling thread without VXR_THREADING. Jobs must not touch 
+    /// ref counted objects shared between them.
+    void runParallel(uint32 num_jobs, std::function<void(uint32 job)> job);
 #ifdef VXR_THREADING
     void submitAsyncTask(threading::Task& task, threading::Sync* sync);
 #endif 
@@ -105,6 +113,9 @@ namespace vxr
 
     ref_ptr<GPU> gpu_;
     ref_ptr<Scene> scene_;
+
+    // Kept between frames so that their command pages are reused.
+    std::vector<scoped_ptr<DisplayList>> display_list_chunks_;
     ref_ptr<AssetManager> asset_manager_;
 
     ref_ptr<System::IBL> ibl_;
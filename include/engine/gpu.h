@@ -27,13 +27,12 @@
 #include "../graphics/window.h"
 #include "../graphics/display_list.h"
 #include "../graphics/render_context.h"
+#include "../graphics/mesh_arena.h"
 
 #include <atomic>
 #include <thread>
 #include <mutex>
 
-/// TODO: Resources are not destroyed yet!
-
 /**
 * \file gpu.h
 *
@@ -60,6 +59,18 @@ namespace vxr
     gpu::Material createMaterial(const gpu::Material::Info& info);
     gpu::Framebuffer createFramebuffer(const gpu::Framebuffer::Info &info);
 
+    // Destruction is deferred: the backend objects are freed by the render thread once every frame 
+    // recorded up to this call has been executed, the handle must not be used in new commands.
+    void destroyBuffer(gpu::Buffer buffer);
+    void destroyTexture(gpu::Texture texture);
+    void destroyMaterial(gpu::Material material);
+    // Also destroys its color and depth textures.
+    void destroyFramebuffer(gpu::Framebuffer framebuffer);
+    // Keeps CPU data read by commands without a copy (persistent FillBuffer payloads) alive until every
+    // frame recorded up to this call has been executed.
+    void releaseData(std::shared_ptr<const void> data);
+
+    // Current size of each resource pool, they grow in pages when all their slots are in use.
     uint32 num_buffers() const;
     uint32 num_textures() const;
     uint32 num_materials() const;
@@ -70,6 +81,45 @@ namespace vxr
     uint32 num_used_materials() const;
     uint32 num_used_framebuffers() const;
 
+    // Maximum number of resources alive at the same time, useful to size the initial pools (Params::GPU).
+    uint32 peak_used_buffers() const;
+    uint32 peak_used_textures() const;
+    uint32 peak_used_materials() const;
+    uint32 peak_used_framebuffers() const;
+
+    struct Stats
+    {
+      struct Pool
+      {
+        uint32 used = 0;
+        uint32 peak_used = 0;
+        uint32 size = 0;
+        uint64 bytes = 0;
+        uint64 peak_bytes = 0;
+      };
+      Pool buffers;
+      Pool textures;
+      Pool materials;
+      Pool framebuffers;
+      // Commands executed and bytes uploaded by the last rendered frame.
+      DisplayList::FrameStats frame;
+      // Highest amount of FillBuffer plus FillTexture bytes uploaded by a single frame.
+      uint64 peak_frame_upload_bytes = 0;
+      uint32 frames = 0;
+    };
+    // Snapshot of the resource memory and upload telemetry, can be called from any thread.
+    Stats stats() const;
+
+    // Shared vertex and index buffers meshes sub-allocate their geometry from.
+    ref_ptr<MeshArena> meshArena();
+
+    uint32 frames_in_flight() const;
+    // Time each thread spent waiting for the other one during the last frame, and total number of stalls.
+    float logic_wait_ms() const;
+    float render_wait_ms() const;
+    uint32 logic_stalls() const;
+    uint32 render_stalls() const;
+
     RenderContext* ctx_;
 
   protected:
@@ -86,34 +136,70 @@ namespace vxr
     bool is_exiting() { return is_exiting_; }
 
   protected:
-    bool is_exiting_ = false;
-    Params::GPU params_ = { 128, 128, 128, 128 };
+    std::atomic<bool> is_exiting_;
+    Params::GPU params_ = { 128, 128, 128, 128, 2 };
     
     ref_ptr<Window> window_;
+    ref_ptr<MeshArena> mesh_arena_;
 
     void moveOrAppendCommands(DisplayList &&dl);
 
+    // Index of the frame the logic thread is currently recording.
+    uint32 recording_frame() const;
+    void destroyResource(const gpu::Resource& resource);
+    // Frees every resource and data released while recording a frame up to 'frame' (or all of them).
+    void releaseResources(uint32 frame, bool all = false);
+
+    struct PendingRelease
+    {
+      gpu::Resource resource;
+      uint32 frame;
+    };
+    struct PendingData
+    {
+      std::shared_ptr<const void> data;
+      uint32 frame;
+    };
+    void publishFrameStats(const DisplayList::FrameStats& frame);
+
+    mutable std::mutex stats_mx_;
+    DisplayList::FrameStats last_frame_stats_;
+    uint64 peak_frame_upload_bytes_ = 0;
+    uint32 frames_rendered_ = 0;
+
+    std::mutex release_mx_;
+    std::vector<PendingRelease> pending_releases_;
+    std::vector<PendingRelease> releasing_;
+    std::vector<PendingData> pending_data_;
+
     scoped_ptr<DisplayList> logic_frame_;
     DisplayList render_frame_;
 
 #ifdef VXR_THREADING
     struct ThreadSync 
     {
-      DisplayList next_frame;
+      // Single producer (logic thread) single consumer (render thread) ring of frames. Indices only 
+      // grow, the slot of an index is (index % num_frames).
+      DisplayList frames[kMaxFramesInFlight];
+      uint32 num_frames = 2;
+      std::atomic<uint32> write_index;
+      std::atomic<uint32> read_index;
+
       std::thread thread;
-      std::mutex mx_r;
       std::mutex mx_l;
-      std::condition_variable cv_r;
       std::condition_variable cv_l;
       bool initialized = false;
     } thread_data_;
 #endif
 
-  private:
-    uint32 num_used_buffers_ = 0;
-    uint32 num_used_textures_ = 0;
-    uint32 num_used_materials_ = 0;
-    uint32 num_used_framebuffers_ = 0;
+    std::atomic<float> logic_wait_ms_;
+    std::atomic<float> render_wait_ms_;
+    std::atomic<uint32> logic_stalls_;
+    std::atomic<uint32> render_stalls_;
+
+#ifndef VXR_THREADING
+    uint32 frame_index_ = 0;
+#endif
 	};
 
 } /* end of vxr namespace */
\ No newline at end of file
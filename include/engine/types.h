@@ -31,6 +31,7 @@
 #include "../memory/ref_ptr.h"
 #include "../memory/scoped_ptr.h"
 #include "../memory/scoped_array.h"
+#include "../memory/paged_array.h"
 
 #include "../../deps/imgui/imgui.h"
 #include "../../deps/imgui/imgui_stl.h"
@@ -85,11 +86,20 @@
 // Platform
 // ----------------------------------------------------------------------------------------
 
-#ifdef _WIN32
+#if defined (_WIN32)
 
 # include <windows.h>
 
 # include <conio.h>
+
+#elif defined (__linux__)
+
+# include <unistd.h>
+
+#else
+#error Missing Platform
+#endif
+
 # include <stdint.h>
 # include <cstddef>
 # include <cstdarg>
@@ -118,10 +128,12 @@ namespace vxr
   typedef ::int8_t			int8;
   typedef ::int16_t			int16;
   typedef ::int32_t			int32;
+  typedef ::int64_t			int64;
 
   typedef ::uint8_t			uint8;
   typedef ::uint16_t		uint16;
   typedef ::uint32_t		uint32;
+  typedef ::uint64_t		uint64;
 
   typedef glm::vec2			vec2;
   typedef glm::vec3			vec3;
@@ -154,16 +166,13 @@ namespace vxr
   namespace threading
   {
     typedef px_sched::Scheduler Scheduler;
+    typedef px_sched::SchedulerParams SchedulerParams;
     typedef px_sched::Sync Sync;
     typedef px_sched::Job Task;
   }
 #endif 
 }
 
-#else
-#error Missing Platform
-#endif
-
 namespace vxr
 {
   // ----------------------------------------------------------------------------------------
@@ -172,6 +181,15 @@ namespace vxr
 
 #ifndef VXR_MESH_PRECOMPUTE_TANGENTS
 #define VXR_MESH_PRECOMPUTE_TANGENTS 1
+#endif
+
+  // SSE paths of the batch kernels (frustum culling...), scalar code is used otherwise.
+#ifndef VXR_SIMD
+#  if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define VXR_SIMD 1
+#  else
+#    define VXR_SIMD 0
+#  endif
 #endif
 
   // ----------------------------------------------------------------------------------------
@@ -183,8 +201,21 @@ namespace vxr
   const size_t kMaxFramebufferColorTextures = 16;
 
   const size_t kMaxUniformBuffers           = 15;
-
-  const size_t kMaxLightSources             = 100;
+  // Offsets of uniform buffer ranges are multiples of this (largest alignment allowed by OpenGL).
+  const size_t kUniformBufferAlignment      = 256;
+
+  const size_t kMaxLightSources             = 256;
+  // View space froxel grid the punctual lights are binned into (see LightClusters), slices are exponential
+  // in depth. Light indices of every cluster share a buffer of kMaxLightClusterIndices bytes.
+  const size_t kLightClustersX              = 16;
+  const size_t kLightClustersY              = 8;
+  const size_t kLightClustersZ              = 16;
+  const size_t kLightClusters               = kLightClustersX * kLightClustersY * kLightClustersZ;
+  const size_t kMaxLightClusterIndices      = 16384;
+  // Instanced draws are split in batches of at most this many instances (Instances uniform block).
+  const size_t kMaxInstancesPerDraw         = 64;
+
+  const size_t kMaxFramesInFlight           = 3;
 
 #ifdef VXR_OPENGL
   const size_t kGLShaderVersion             = 330;
@@ -221,11 +252,21 @@ namespace vxr
 
     struct GPU
     {
+      // Initial capacity of the resource pools, they grow in pages when exhausted.
       uint32 max_buffers = 128;
       uint32 max_textures = 128;
       uint32 max_materials = 128;
       uint32 max_framebuffers = 128;
+      // Frames queued between logic and render threads (VXR_THREADING). 1 gives the lowest latency, 
+      // up to kMaxFramesInFlight absorbs hiccups of either thread at the cost of latency.
+      uint32 frames_in_flight = 2;
     } gpu;
+
+    struct Scheduler
+    {
+      // Workers running jobs at the same time (VXR_THREADING), 0 uses every hardware thread.
+      uint32 max_running_threads = 0;
+    } scheduler;
   };
 
   struct TransformSpace
@@ -26,6 +26,7 @@
 
 #include "../graphics/materials/pass_standard.h"
 #include "../graphics/materials/standard.h"
+#include "../graphics/retained_display_list.h"
 
 /**
 * \file composer.h
@@ -74,6 +75,8 @@ namespace vxr
     ref_ptr<Texture> screen_texture_;
     ref_ptr<Texture> displaytest;
 
+    RetainedDisplayList render_to_screen_commands_;
+
     bool initialized_ = false;
   };
 
@@ -27,6 +27,8 @@
 #include "../core/object.h"
 #include "../graphics/gpu_resources.h"
 
+#include <memory>
+
 #include "../engine/ignore_warnings.h" // Ignore "same type qualifier used more than once" warning (C4114)
 
 /**
@@ -39,18 +41,41 @@
 */
 namespace vxr
 {
+  class RetainedDisplayList;
 
   class DisplayList : public Object
   {
     VXR_OBJECT(DisplayList, Object)
     friend class GPU;
+    friend class RetainedDisplayList;
   public:
     DisplayList();
     ~DisplayList();
 
     struct Command;
 
-    void update();
+    /// Counters of the commands executed in a frame, filled by the render thread (see GPU::stats()).
+    struct FrameStats
+    {
+      uint32 setup_views = 0;
+      uint32 clears = 0;
+      uint32 fill_buffers = 0;
+      uint32 fill_textures = 0;
+      uint32 setup_materials = 0;
+      uint32 renders = 0;
+      uint32 retained_lists = 0;
+      uint32 retained_commands = 0;
+      uint64 fill_buffer_bytes = 0;
+      uint64 fill_texture_bytes = 0;
+      /// Bytes copied to the staging buffer from the frame upload pages.
+      uint64 transient_bytes = 0;
+    };
+
+    void update(FrameStats* stats = nullptr);
+    void reset();
+
+    bool empty() const;
+    uint32 num_commands() const;
 
 // ----------------------------------------------------------------------------------------
 //  The following structures have been partially extracted from px_render.h 
@@ -59,7 +84,7 @@ namespace vxr
 
 #define PROPERTY(type, name, ...) \
       type name = __VA_ARGS__;\
-      Self& set_##name(const type &c) { name = c; return *this; }
+      Self& set_##name(type const &c) { name = c; return *this; }
 
 #define PROPERTY_PTR(type, name) \
       const type *name = nullptr;\
@@ -67,7 +92,7 @@ namespace vxr
 
 #define PROP_ARRAY(type, count, name) \
       type name[count] = {};\
-      Self& set_##name(size_t i, const type &c) { name[i] = c; return *this; }\
+      Self& set_##name(size_t i, type const &c) { name[i] = c; return *this; }\
       Self& set_v_##name(std::vector<type> c) { for (uint32 i = 0; i < c.size(); ++i) { set_##name(i, c[i]); } return *this; }
 
     struct SetupViewData 
@@ -105,6 +130,13 @@ namespace vxr
       PROPERTY(uint32, offset, 0);
       PROPERTY(uint32, size, 0);
       PROPERTY_PTR(void, data);
+      // The data is read in place instead of being copied when the list is submitted. Only for data that
+      // outlives every frame in flight, e.g. handed to GPU::releaseData() once the command is recorded.
+      PROPERTY(bool, persistent, false);
+
+      // Set when the payload has been copied to the upload pages of the frame.
+      bool transient = false;
+      uint32 transient_offset = 0;
     };
 
     struct FillTextureData 
@@ -133,6 +165,13 @@ namespace vxr
       PROP_ARRAY(gpu::Texture, kMaxTextureUnits, texture);
       PROP_ARRAY(gpu::Buffer, kMaxVertexAttribs, buffer);
       PROP_ARRAY(gpu::Buffer, kMaxUniformBuffers + 1, uniform_buffer);
+      // Binds only [offset, offset + size) of the uniform buffer when size is not 0. Offsets must be
+      // multiples of kUniformBufferAlignment.
+      PROP_ARRAY(uint32, kMaxUniformBuffers + 1, uniform_buffer_offset);
+      PROP_ARRAY(uint32, kMaxUniformBuffers + 1, uniform_buffer_size);
+      // Uniform block bound to each slot, defaults to the name of the buffer. Needed when a buffer
+      // holds blocks of different materials.
+      PROP_ARRAY(const char*, kMaxUniformBuffers + 1, uniform_block);
       PROPERTY(vec4, scissor, {});
       PROPERTY(mat4, model_matrix, mat4());
     };
@@ -145,6 +184,8 @@ namespace vxr
       PROPERTY(uint32, count, 0);
       PROPERTY(uint32, instances, 1);
       PROPERTY(IndexFormat::Enum, type, IndexFormat::UInt16);
+      // Added to every index, lets meshes share vertex buffers (see MeshArena).
+      PROPERTY(uint32, base_vertex, 0);
     };
 
 #undef PROPERTY
@@ -158,10 +199,64 @@ namespace vxr
     SetupMaterialData&  setupMaterialCommand();
     RenderData&         renderCommand();
 
+    /// Executes the commands of a finished retained display list at this point of the frame, 
+    /// without copying them. Returns false (adding nothing) if the retained list is not valid.
+    bool retainedCommand(const RetainedDisplayList& retained);
+
 // ----------------------------------------------------------------------------------------
 
   private:
-    std::vector<scoped_ptr<Command>> commands_;
+    /// Commands are stored as a POD header followed by its payload, packed contiguously
+    /// in fixed size pages. Pages are never moved nor freed on reset, so references
+    /// returned by the builder functions remain valid until the list is executed.
+    static const uint32 kPageSize = 32 * 1024;
+
+    struct Page
+    {
+      alignas(16) uint8 data[kPageSize];
+      uint32 used = 0;
+    };
+
+    struct RetainedData
+    {
+      const DisplayList* commands;
+    };
+
+    /// Pages of the lists destroyed on the calling thread are kept (up to kMaxPooledPages) and handed
+    /// to the next lists, so short lived lists recording a handful of commands do not allocate.
+    static const uint32 kMaxPooledPages = 32;
+    static std::vector<scoped_ptr<Page>>& PooledPages();
+    static scoped_ptr<Page> AcquirePage();
+    static void ReleasePages(std::vector<scoped_ptr<Page>>* pages);
+
+    template<class T> T& push(uint16 type);
+    void execute(FrameStats* stats = nullptr) const;
+    static void CountCommand(Command* c, FrameStats* stats);
+    void* allocate(uint32 size);
+    bool upload(FillBufferData* d);
+    bool uploadPages(FillBufferData* d);
+    Page* nextUploadPage();
+    uint32 flushUploads();
+
+    void swap(DisplayList& other);
+    void append(DisplayList& other);
+
+    std::vector<scoped_ptr<Page>> pages_;
+    uint32 num_pages_used_ = 0;
+    uint32 num_commands_ = 0;
+
+    /// Upload pages kept by a list between frames, the ones over it are freed once the frame has been
+    /// executed, so an occasional large payload does not hold on to its memory.
+    static const uint32 kMaxUploadPages = 64;
+
+    /// FillBuffer payloads are copied here when the list is submitted, so the logic thread is free 
+    /// to modify the source data while this frame is rendered. Every frame in flight owns its pages.
+    std::vector<scoped_ptr<Page>> upload_pages_;
+    uint32 num_upload_pages_used_ = 0;
+    RenderContext* upload_ctx_ = nullptr;
+
+    /// Retained display lists referenced by this list, kept alive until it has been executed.
+    std::vector<std::shared_ptr<DisplayList>> retained_;
 
   };
 } /* end of vxr namespace */
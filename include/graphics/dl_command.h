@@ -38,60 +38,34 @@
 namespace vxr
 {
 
-  struct DisplayList::Command : public Referenced
+  struct DisplayList::Command
   {
-    Command();
-    virtual ~Command();
-    
-    virtual void execute() = 0;
-  };
-
-  struct SetupViewCommand : DisplayList::Command
-  {
-    friend class DisplayList;
-    void execute() override;
-
-    DisplayList::SetupViewData data_;
-  };
-
-  struct ClearCommand : DisplayList::Command
-  {
-    friend class DisplayList;
-    void execute() override;
-
-    DisplayList::ClearData data_;
-  };
+    enum Type : uint16
+    {
+      SetupView,
+      Clear,
+      FillBuffer,
+      FillTexture,
+      SetupMaterial,
+      Render,
+      Retained,
+    };
 
-  struct FillBufferCommand : DisplayList::Command
-  {
-    friend class DisplayList;
-    void execute() override;
+    static const uint32 kAlignment = 16;
 
-    DisplayList::FillBufferData data_;
-  };
+    /// Header size, so that the payload that follows it stays aligned.
+    static uint32 HeaderSize() { return (sizeof(Command) + kAlignment - 1) & ~(kAlignment - 1); }
 
-  struct FillTextureCommand : DisplayList::Command
-  {
-    friend class DisplayList;
-    void execute() override;
+    void* payload() { return (uint8*)this + HeaderSize(); }
 
-    DisplayList::FillTextureData data_;
-  };
+    void execute();
 
-  struct SetupMaterialCommand : DisplayList::Command
-  {
-    friend class DisplayList;
-    void execute() override;
-
-    DisplayList::SetupMaterialData data_;
-  };
-
-  struct RenderCommand : DisplayList::Command
-  {
-    friend class DisplayList;
-    void execute() override;
+    static void BeginUploads(RenderContext* ctx, uint32 size);
+    static void Upload(RenderContext* ctx, uint32 offset, const void* data, uint32 size);
 
-    DisplayList::RenderData data_;
+    uint16 type;
+    uint16 reserved;
+    uint32 size; ///< Header plus payload size in bytes.
   };
 
 } /* end of vxr namespace */
\ No newline at end of file
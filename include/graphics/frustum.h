@@ -0,0 +1,95 @@
+#pragma once
+
+// ----------------------------------------------------------------------------------------
+// MIT License
+// 
+// Copyright(c) 2018 Vctor vila
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ----------------------------------------------------------------------------------------
+
+#include "../engine/types.h"
+
+/**
+* \file frustum.h
+*
+* \author Victor Avila (avilapa.github.io)
+*
+* \brief Bounding volumes and view frustum culling. Boxes are culled in batches stored as a 
+* structure of arrays, testing four of them per plane at once when VXR_SIMD is enabled.
+*
+*/
+namespace vxr
+{
+
+  /// Local space axis aligned box and enclosing sphere of a set of points.
+  struct Bounds
+  {
+    vec3 min = vec3(0.0f);
+    vec3 max = vec3(0.0f);
+    vec3 center = vec3(0.0f);
+    float radius = 0.0f;
+
+    static Bounds FromPoints(const std::vector<vec3>& points);
+
+    /// Center and half extents of the world space box enclosing this one transformed by 'transform'.
+    void transform(const mat4& transform, vec3* world_center, vec3* world_extents) const;
+  };
+
+  class Frustum
+  {
+  public:
+    /// Extracts the six planes (normals pointing inwards) of a view projection matrix.
+    void set(const mat4& view_projection);
+
+    bool test(const vec3& center, const vec3& extents) const;
+    const vec4& plane(uint32 i) const;
+
+  private:
+    vec4 planes_[6];
+  };
+
+  class FrustumCuller
+  {
+  public:
+    void clear();
+    void add(const vec3& center, const vec3& extents);
+
+    /// Appends to 'visible' the indices, in insertion order, of the boxes intersecting the frustum.
+    void cull(const Frustum& frustum, std::vector<uint32>* visible) const;
+
+    uint32 size() const;
+
+    /// Culls with the scalar path when false, to compare it with the SIMD one. No effect without VXR_SIMD.
+    void set_simd(bool enabled);
+
+  private:
+#if VXR_SIMD
+    /// Four boxes per plane test.
+    void cullSIMD(const Frustum& frustum, std::vector<uint32>* visible) const;
+#endif
+
+    /// Box centers and half extents, padded to a multiple of 4 boxes.
+    std::vector<float> cx_, cy_, cz_;
+    std::vector<float> ex_, ey_, ez_;
+    uint32 count_ = 0;
+    bool simd_ = true;
+  };
+
+} /* end of vxr namespace */
\ No newline at end of file
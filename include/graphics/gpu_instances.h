@@ -50,10 +50,13 @@ namespace vxr
     {
       uint32 version = 0;
       std::atomic<uint32> state = { 0 };
+      // GPU memory accounted to the resource, see RenderContext::SetInstanceMemory.
+      uint64 bytes = 0;
 
       bool acquire()
       {
-        uint32 v = (version + 1);
+        // Versions live in the upper 12 bits of the resource id, 0 is never a valid one.
+        uint32 v = (version + 1) & 0xFFF;
         if (!v) v = 1;
         uint32 e = 0;
         if (state.compare_exchange_weak(e, v))
@@ -96,6 +99,91 @@ namespace vxr
       Texture depth_texture;
     };
 
+    // Lock-free stack of free slot indices of an instance pool (Treiber stack). The head packs
+    // (index + 1) in its lower 32 bits and a tag in the upper ones, bumped on every change so
+    // that a concurrent pop/push of the same slot (ABA) makes the compare exchange fail.
+    class FreeList
+    {
+    public:
+      static const uint32 kEmpty = 0xFFFFFFFF;
+
+      // Makes the new slots [size(), size) available. Calls must be serialized, pop/push may run concurrently.
+      void grow(uint32 size)
+      {
+        uint32 first = (uint32)next_.size();
+        next_.grow(size);
+        for (uint32 i = (uint32)next_.size(); i > first; --i)
+        {
+          link(i - 1);
+        }
+      }
+
+      // Returns the index of a free slot or kEmpty if the pool is exhausted. O(1).
+      uint32 pop()
+      {
+        uint32 index = unlink();
+        if (index != kEmpty)
+        {
+          uint32 used = ++used_;
+          uint32 high_water = high_water_.load(std::memory_order_relaxed);
+          while (used > high_water && !high_water_.compare_exchange_weak(high_water, used)) {}
+        }
+        return index;
+      }
+
+      void push(uint32 index)
+      {
+        link(index);
+        used_--;
+      }
+
+      bool empty() const { return !(uint32)(head_.load(std::memory_order_acquire) & 0xFFFFFFFF); }
+      uint32 size() const { return (uint32)next_.size(); }
+      uint32 used() const { return used_; }
+      // Maximum number of slots that have been in use at the same time.
+      uint32 high_water() const { return high_water_; }
+
+    private:
+      uint32 unlink()
+      {
+        uint64 head = head_.load(std::memory_order_acquire);
+        for (;;)
+        {
+          uint32 first = (uint32)(head & 0xFFFFFFFF);
+          if (!first)
+          {
+            return kEmpty;
+          }
+          uint64 tag = (head >> 32) + 1;
+          uint64 new_head = (tag << 32) | next_[first - 1].load(std::memory_order_relaxed);
+          if (head_.compare_exchange_weak(head, new_head, std::memory_order_acquire, std::memory_order_acquire))
+          {
+            return first - 1;
+          }
+        }
+      }
+
+      void link(uint32 index)
+      {
+        uint64 head = head_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+          next_[index].store((uint32)(head & 0xFFFFFFFF), std::memory_order_relaxed);
+          uint64 tag = (head >> 32) + 1;
+          uint64 new_head = (tag << 32) | (index + 1);
+          if (head_.compare_exchange_weak(head, new_head, std::memory_order_release, std::memory_order_relaxed))
+          {
+            return;
+          }
+        }
+      }
+
+      std::atomic<uint64> head_ = { 0 };
+      std::atomic<uint32> used_ = { 0 };
+      std::atomic<uint32> high_water_ = { 0 };
+      paged_array<std::atomic<uint32>> next_;
+    };
+
   } /* end of gpu namespace */
 
 } /* end of vxr namespace */
\ No newline at end of file
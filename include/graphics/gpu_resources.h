@@ -126,6 +126,9 @@ namespace vxr
         CompareFunc::Enum depth_func = CompareFunc::Less;
         bool rgba_write = true;
         bool depth_write = true;
+        // Shaders are compiled with INSTANCED defined, reading the model matrix (and material 
+        // uniforms) of each instance from the Instances uniform block.
+        bool instanced = false;
       };
     };
 
@@ -0,0 +1,87 @@
+#pragma once
+
+// ----------------------------------------------------------------------------------------
+// MIT License
+// 
+// Copyright(c) 2018 Vctor vila
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ----------------------------------------------------------------------------------------
+
+#include "materials/shader.h"
+
+/**
+* \file light_clusters.h
+*
+* \author Victor Avila (avilapa.github.io)
+*
+* \brief Clustered light culling. The view frustum is split into a grid of froxels (kLightClustersX x 
+* kLightClustersY tiles, kLightClustersZ exponential depth slices) and every punctual light is binned into
+* the froxels its range overlaps, so that fragments only evaluate the lights of their own cluster. Spheres
+* are tested against four froxel boxes at a time when VXR_SIMD is enabled.
+*
+*/
+namespace vxr
+{
+
+  class LightClusters
+  {
+  public:
+    /// Builds the view space boxes of the froxels, only when the projection changes.
+    void setup(const mat4& projection, float near_plane, float far_plane);
+    /// Transforms the punctual lights in the given slots of the light data into view space spheres. Their
+    /// range ends where the distance attenuation reaches zero (1 / sqrt(falloff)).
+    void begin(const mat4& view, const Shader::LightData& lights, const uint8* slots, uint32 count);
+
+    /// Bins the lights into the clusters of a depth slice. Slices do not share clusters, so they can be
+    /// binned in parallel.
+    void bin(uint32 slice);
+
+    /// Packs the slots of the directional lights, evaluated by every cluster, followed by the light lists
+    /// of every cluster. Lists not fitting kMaxLightClusterIndices are truncated, returns false in that case.
+    bool compact(const uint8* directional, uint32 num_directional, Shader::LightClusterData* clusters, Shader::LightIndexData* indices);
+
+    uint32 num_slices() const;
+    uint32 num_indices() const;
+
+  private:
+    // Froxel boxes in view space (structure of arrays, tiles of a slice are consecutive).
+    float min_x_[kLightClusters], min_y_[kLightClusters], min_z_[kLightClusters];
+    float max_x_[kLightClusters], max_y_[kLightClusters], max_z_[kLightClusters];
+    // View depth range of each slice.
+    float slice_near_[kLightClustersZ];
+    float slice_far_[kLightClustersZ];
+    float depth_scale_ = 0.0f;
+    float depth_bias_ = 0.0f;
+
+    mat4 projection_ = mat4(0.0f);
+    float near_plane_ = 0.0f;
+    float far_plane_ = 0.0f;
+
+    // View space center and radius of the lights, and their slot in the light data.
+    std::vector<vec4> spheres_;
+    std::vector<uint8> slots_;
+
+    // Up to kMaxLightSources light indices per cluster, filled by bin().
+    std::vector<uint8> lights_;
+    uint16 counts_[kLightClusters] = {};
+    uint32 num_indices_ = 0;
+  };
+
+} /* end of vxr namespace */
\ No newline at end of file
@@ -64,24 +64,44 @@ namespace vxr
       void set_uniforms_name(const char* name);
       void set_uniforms_usage(Usage::Enum usage);
 
+      // Opaque renderers sharing mesh, material and textures are drawn with a single instanced draw 
+      // when the shaders support it (see Shader::Instanced). Must be set before setup().
+      void set_instancing_enabled(bool enabled);
+      // Opaque materials drawn after a depth pre-pass (see Camera::depth_prepass) only shade the visible
+      // pixels. The pre-pass only computes getClipPosition(), so materials moving their vertices in any
+      // other way must disable it. Must be set before setup().
+      void set_depth_prepass_enabled(bool enabled);
+
       bool uniforms_enabled() const;
 
       // Returning false does not output any errors to console.
       bool setup();
-      bool setupTextureTypes(std::vector<ref_ptr<Texture>> textures);
+      bool setupTextureTypes(const std::vector<ref_ptr<Texture>>& textures);
 
       gpu::Material material() const;
+      // Invalid if the material can not be instanced.
+      gpu::Material instancedMaterial() const;
+      // Variants testing depth with CompareFunc::Equal without writing it, drawn after the depth pre-pass.
+      // Invalid if the material can not use the pre-pass.
+      gpu::Material equalDepthMaterial() const;
+      gpu::Material equalDepthInstancedMaterial() const;
       gpu::Buffer uniformBuffer() const;
       std::vector<gpu::Texture> textureInput() const;
 
       // Common textures must have lower indices than instance textures.
       void set_common_texture(uint32 index, ref_ptr<Texture> texture);
 
+      // Incremented every time a common texture is replaced, so that cached copies of the textures can be refreshed.
+      uint32 version() const;
+
     private:
       bool initialized_ = false;
       bool use_uniforms_ = true;
+      bool use_instancing_ = true;
+      bool use_depth_prepass_ = true;
 
       uint32 common_textures_;
+      uint32 version_ = 0;
 
       const char* uniforms_name_ = "Uniforms";
       Usage::Enum uniforms_usage_ = Usage::Dynamic;
@@ -89,6 +109,9 @@ namespace vxr
       struct GPU
       {
         gpu::Material mat;
+        gpu::Material instanced;
+        gpu::Material equal;
+        gpu::Material equal_instanced;
         gpu::Material::Info info;
         gpu::Buffer uniform_buffer;
         std::vector<gpu::Texture> tex;
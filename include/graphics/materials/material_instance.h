@@ -67,12 +67,16 @@ namespace vxr
 
       void set_texture(uint32 index, ref_ptr<Texture> texture);
       ref_ptr<Texture> texture(uint32 index = 0) const;
-      std::vector<ref_ptr<Texture>> textures() const;
+      const std::vector<ref_ptr<Texture>>& textures() const;
+
+      // Incremented every time the active material or a texture changes.
+      uint32 version() const;
 
       Shader::UniformData uniforms_;
 
     private:
       uint32 active_material_;
+      uint32 version_ = 0;
       std::vector<ref_ptr<Material>> shared_materials_;
       std::vector<std::vector<ref_ptr<Texture>>> textures_;
     };
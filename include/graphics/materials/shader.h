@@ -62,6 +62,21 @@ namespace vxr
       vec4 direction_ambient[kMaxLightSources];
     };
 
+    struct LightClusterData
+    {
+      // x, y: scale and bias of log(view depth) to depth slice, z: number of directional lights (listed first).
+      vec4 params;
+      // Offset of the first light index of each cluster (upper 16 bits) and number of lights (lower 16 bits).
+      uint32 cells[kLightClusters];
+    };
+
+    struct LightIndexData
+    {
+      // Slots of the directional lights followed by the lights of every cluster, packed as uvec4 (16 indices
+      // each) in the shaders.
+      uint8 indices[kMaxLightClusterIndices];
+    };
+
     union UniformData
     {
       // Add here specific uniform structures for any new shaders (only float x2/vec2/vec4).
@@ -89,6 +104,18 @@ namespace vxr
       } planet;
     };
 
+    // Element of the Instances uniform block read by instanced materials (std140 layout).
+    struct InstanceData
+    {
+      mat4 model;
+      UniformData uniforms;
+    };
+
+    // Builds the instanced variant of a material's shaders. The members of its 'block' uniform 
+    // block become globals filled from the instance uniforms by a main() wrapper, so only blocks 
+    // made of vec4 members are supported. Returns false if the material can not be instanced.
+    bool Instanced(const string& vert, const string& frag, const char* block, string* instanced_vert, string* instanced_frag);
+
   } /* end of Shader namespace */
 
 } /* end of vxr namespace */
\ No newline at end of file
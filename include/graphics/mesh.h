@@ -25,6 +25,8 @@
 // ----------------------------------------------------------------------------------------
 
 #include "../graphics/render_context.h"
+#include "../graphics/mesh_arena.h"
+#include "../graphics/frustum.h"
 
 /**
 * \file mesh.h
@@ -66,38 +68,51 @@ namespace vxr
     void recomputeNormals();
     void recomputeTangents();
 
+    // Kept as a hint, the shared arena buffers the geometry lives in are static.
     void set_usage(Usage::Enum usage);
 
     bool hasChanged();
+    // Incremented every time setup() uploads new geometry.
+    uint32 version() const;
     string path() const;
+    bool loading() const;
 
     bool setup();
 
     uint32 indexCount() const;
     IndexFormat::Enum indexFormat() const;
 
+    // Local space bounds, recomputed by setup() when the vertices change.
+    const Bounds& bounds() const;
+
+    // Meshes are sub-allocated from the shared MeshArena buffers, draws must use the index offset 
+    // (in bytes) and the base vertex of the mesh within them.
     gpu::Buffer vertexBuffer() const;
     gpu::Buffer indexBuffer() const;
+    uint32 indexOffset() const;
+    uint32 baseVertex() const;
 
   private:
     string path_ = "";
     bool loading_ = false;
     bool dirty_ = true;
+    uint32 version_ = 0;
 
     Usage::Enum usage_ = Usage::Static;
+    Bounds bounds_;
 
     struct GPU
     {
       struct Vertex
       {
-        gpu::Buffer buffer;
-        std::vector<float> data;
+        MeshArena::Range range;
+        std::shared_ptr<std::vector<float>> data;
       } vertex;
 
       struct Index
       {
-        gpu::Buffer buffer;
-        std::vector<uint32> data;
+        MeshArena::Range range;
+        std::shared_ptr<std::vector<uint32>> data;
       } index;
     } gpu_;
   };
@@ -0,0 +1,149 @@
+#pragma once
+
+// ----------------------------------------------------------------------------------------
+// MIT License
+// 
+// Copyright(c) 2018 Vctor vila
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ----------------------------------------------------------------------------------------
+
+#include "../core/object.h"
+#include "gpu_resources.h"
+
+#include <map>
+#include <mutex>
+
+/**
+* \file mesh_arena.h
+*
+* \author Victor Avila (avilapa.github.io)
+*
+* \brief Mesh geometry arena. Meshes sub-allocate their vertices and indices from a few large 
+* vertex and index buffers (blocks) instead of owning a pair of buffers each, so that consecutive 
+* draws keep the same buffers bound and drawing thousands of small meshes does not take thousands 
+* of resource slots. Draws address their range through the index offset and the base vertex.
+*
+*/
+namespace vxr
+{
+
+  /// Offset allocator over a range of [0, size) elements. Free ranges are kept both by offset, to 
+  /// coalesce them on release, and by size, for O(log n) best fit allocations.
+  class RangeAllocator
+  {
+  public:
+    static const uint32 kInvalid = 0xFFFFFFFF;
+
+    void init(uint32 size);
+    /// Returns the offset of 'count' contiguous elements or kInvalid if no free range fits them.
+    uint32 allocate(uint32 count);
+    void free(uint32 offset, uint32 count);
+
+    uint32 size() const;
+    uint32 used() const;
+    uint32 largest_free() const;
+    uint32 num_free_ranges() const;
+    /// 0 when all the free space is contiguous, close to 1 when it is scattered in small ranges.
+    float fragmentation() const;
+
+  private:
+    void insert(uint32 offset, uint32 count);
+    void erase(std::map<uint32, uint32>::iterator it);
+
+    uint32 size_ = 0;
+    uint32 used_ = 0;
+    std::map<uint32, uint32> free_by_offset_;
+    std::multimap<uint32, uint32> free_by_size_;
+  };
+
+  class MeshArena : public Object
+  {
+    VXR_OBJECT(MeshArena, Object);
+  public:
+    MeshArena();
+    ~MeshArena();
+
+    static const uint32 kInvalidBlock = 0xFFFFFFFF;
+    /// Default size of the blocks in bytes, larger meshes get a block of their own.
+    static const uint32 kVertexBlockSize = 8 * 1024 * 1024;
+    static const uint32 kIndexBlockSize = 4 * 1024 * 1024;
+
+    /// Range of a mesh within a block, in elements (vertices or indices). Owned by the mesh and
+    /// updated by the arena when defragmentation moves it.
+    struct Range
+    {
+      uint32 block = kInvalidBlock;
+      uint32 offset = 0;
+      uint32 count = 0;
+      /// CPU copy of the range, uploaded again when the range is moved. Must outlive the range and the frames
+      /// uploading it (see GPU::releaseData()).
+      const void* data = nullptr;
+    };
+
+    /// Allocates and uploads 'count' vertices of 'vertex_size' bytes. All vertices of the arena 
+    /// must share the same size, as blocks are addressed in vertices (base vertex).
+    bool allocateVertices(uint32 count, uint32 vertex_size, const void* data, Range* range);
+    bool allocateIndices(uint32 count, const uint32* data, Range* range);
+    void freeVertices(Range* range);
+    void freeIndices(Range* range);
+
+    gpu::Buffer vertexBuffer(const Range& range) const;
+    gpu::Buffer indexBuffer(const Range& range) const;
+
+    /// Compacts every block whose free space is more fragmented than 'threshold', uploading the
+    /// moved ranges again. Called once per frame, before recording the draws that use the ranges.
+    void defragment(float threshold = 0.5f);
+
+    /// Incremented every time defragmentation moves a range, cached copies of ranges must be read again.
+    uint32 generation() const;
+
+    uint32 num_blocks() const;
+    uint64 used_bytes() const;
+    uint64 allocated_bytes() const;
+
+  private:
+    struct Block
+    {
+      gpu::Buffer buffer;
+      RangeAllocator allocator;
+      std::map<uint32, Range*> ranges;
+    };
+
+    struct Pool
+    {
+      BufferType::Enum type;
+      uint32 element_size = 0;
+      uint32 block_size = 0;
+      const char* name = "";
+      std::vector<Block*> blocks;
+    };
+
+    bool allocate(Pool* pool, uint32 count, const void* data, Range* range);
+    void free(Pool* pool, Range* range);
+    void compact(Pool* pool, Block* block);
+    void upload(const Pool& pool, const Block& block, const Range& range);
+
+    Pool vertices_;
+    Pool indices_;
+    uint32 generation_ = 0;
+    mutable std::mutex mutex_;
+  };
+
+} /* end of vxr namespace */
\ No newline at end of file
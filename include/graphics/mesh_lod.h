@@ -0,0 +1,134 @@
+#pragma once
+
+// ----------------------------------------------------------------------------------------
+// MIT License
+// 
+// Copyright(c) 2018 Vctor vila
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ----------------------------------------------------------------------------------------
+
+#include "../core/object.h"
+
+#include <atomic>
+
+/**
+* \file mesh_lod.h
+*
+* \author Victor Avila (avilapa.github.io)
+*
+* \brief Mesh level of detail chains. Levels are simplified with quadric error edge collapses on a
+* worker thread and cached to disk next to the source mesh.
+*
+*/
+namespace vxr
+{
+
+  class Mesh;
+
+  namespace lod
+  {
+    /// Simplifies a triangle list with quadric error edge collapses until it has at most 'target_index_count'
+    /// indices or no collapse stays below 'max_error' (relative to the mesh radius). Collapses move a vertex
+    /// onto one of its neighbours, so 'result' indexes the same vertices. Vertices sharing their position
+    /// with others (attribute seams) or lying on open borders never move. Returns the resulting error.
+    float Simplify(const std::vector<vec3>& positions, const std::vector<uint32>& indices, uint32 target_index_count, float max_error, std::vector<uint32>* result);
+  }
+
+  class MeshLOD : public Object
+  {
+    VXR_OBJECT(MeshLOD, Object);
+  public:
+    MeshLOD();
+    virtual ~MeshLOD();
+
+    virtual void onGUI() override;
+
+    static const uint32 kMaxLevels = 4;
+
+    struct Params
+    {
+      uint32 num_levels = kMaxLevels;
+      // Fraction of the triangles of the previous level each level is reduced to.
+      float reduction = 0.5f;
+      // Levels whose error would exceed this (relative to the mesh radius) are not generated.
+      float max_error = 0.05f;
+      // Screen height fraction below which level 1 is drawn, halved for every following level.
+      float screen_size = 0.3f;
+    };
+
+    /// Level 0 is 'mesh' itself. The cache file is read instead of simplifying the mesh when it matches,
+    /// and written after simplifying otherwise. Empty disables caching.
+    void set_source(ref_ptr<Mesh> mesh, const string& cache_file = "");
+    ref_ptr<Mesh> source() const;
+
+    /// Must be set before the chain is built, resets the screen sizes.
+    void set_params(const Params& params);
+
+    /// Starts generating the levels once the source mesh is loaded (on a worker with VXR_THREADING) and
+    /// creates their meshes when done, returns true when the chain is complete. Called every time the
+    /// chain is used until then, from the render thread.
+    bool build();
+
+    uint32 num_levels() const;
+    ref_ptr<Mesh> level(uint32 index) const;
+    /// Screen height fraction below which the level is drawn.
+    float screen_size(uint32 index) const;
+    void set_screen_size(uint32 index, float screen_size);
+
+    /// Incremented every time build() completes the chain, once its levels can be used.
+    uint32 version() const;
+
+  private:
+    struct State
+    {
+      enum Enum
+      {
+        Idle,
+        Generating,
+        Generated,
+        Ready,
+      };
+    };
+
+    struct LevelData
+    {
+      // Source vertices used by the level and indices into them.
+      std::vector<uint32> vertices;
+      std::vector<uint32> indices;
+      float error = 0.0f;
+    };
+
+    void generate();
+    bool load();
+    void save() const;
+
+    ref_ptr<Mesh> source_;
+    Params params_;
+    string cache_file_;
+
+    std::vector<ref_ptr<Mesh>> levels_;
+    float screen_sizes_[kMaxLevels];
+
+    std::vector<LevelData> data_;
+    std::atomic<uint32> state_;
+    std::atomic<uint32> version_;
+  };
+
+} /* end of vxr namespace */
\ No newline at end of file
@@ -0,0 +1,112 @@
+#pragma once
+
+// ----------------------------------------------------------------------------------------
+// MIT License
+// 
+// Copyright(c) 2018 Vctor vila
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ----------------------------------------------------------------------------------------
+
+#include "../engine/types.h"
+
+/**
+* \file occlusion.h
+*
+* \author Victor Avila (avilapa.github.io)
+*
+* \brief Software occlusion culling. Occluder triangles are rasterized into a low resolution CPU depth
+* buffer made of tiles of 8x4 pixels, each one keeping a coverage mask and two depth layers (masked depth
+* buffer). Boxes farther than every tile they overlap are hidden. Coverage is computed four pixels at a
+* time when VXR_SIMD is enabled.
+*
+*/
+namespace vxr
+{
+
+  class OcclusionBuffer
+  {
+  public:
+    static const uint32 kTileWidth = 8;
+    static const uint32 kTileHeight = 4;
+    /// Rows of tiles rasterized together, see rasterize().
+    static const uint32 kTilesPerBand = 4;
+
+    /// Resolution in pixels, rounded up to whole tiles.
+    void resize(uint32 width, uint32 height);
+    /// Clears the depth and the binned triangles of the previous frame.
+    void begin(const mat4& view_projection);
+
+    /// Transforms the triangles of an occluder and bins the front facing ones into bands of tiles.
+    /// Triangles crossing the near plane are dropped, occluding less than they could.
+    void addOccluder(const mat4& model, const std::vector<vec3>& vertices, const std::vector<uint32>& indices);
+
+    /// Rasterizes the triangles overlapping a band of tile rows. Bands do not share tiles, so they can
+    /// be rasterized in parallel.
+    void rasterize(uint32 band);
+
+    /// True if the world space box is hidden behind the rasterized occluders. Read only, boxes can be
+    /// tested in parallel once every band has been rasterized.
+    bool occluded(const vec3& center, const vec3& extents) const;
+
+    uint32 width() const;
+    uint32 height() const;
+    uint32 num_bands() const;
+    uint32 num_triangles() const;
+
+    /// Computes coverage with the scalar path when false, to compare it with the SIMD one. No effect
+    /// without VXR_SIMD.
+    void set_simd(bool enabled);
+
+  private:
+    struct Triangle
+    {
+      // Edge functions a*x + b*y + c, positive inside, in pixels.
+      float a[3], b[3], c[3];
+      // Farthest depth (view space w) of the triangle.
+      float depth;
+      // Pixel bounds, inclusive.
+      int32 min_x, min_y, max_x, max_y;
+    };
+
+    // Depth of every pixel of a tile is nearer than z0. z1 is the farthest depth of the pixels in
+    // 'mask', a working layer merged into z0 once it covers the whole tile.
+    struct Tile
+    {
+      float z0;
+      float z1;
+      uint32 mask;
+    };
+
+    void update(Tile* tile, uint32 coverage, float depth);
+
+    mat4 view_projection_ = mat4(1.0f);
+    uint32 width_ = 0;
+    uint32 height_ = 0;
+    uint32 tiles_x_ = 0;
+    uint32 tiles_y_ = 0;
+    std::vector<Tile> tiles_;
+    std::vector<Triangle> triangles_;
+    // Indices of the triangles overlapping each band.
+    std::vector<std::vector<uint32>> bands_;
+    std::vector<vec4> clip_;
+    bool simd_ = true;
+  };
+
+} /* end of vxr namespace */
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+// ----------------------------------------------------------------------------------------
+// MIT License
+// 
+// Copyright(c) 2018 Vctor vila
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ----------------------------------------------------------------------------------------
+
+#include "../engine/types.h"
+
+/**
+* \file render_bucket.h
+*
+* \author Victor Avila (avilapa.github.io)
+*
+* \brief Bucket of draws sorted by a 64-bit key, used to minimize state changes on submission.
+*
+* Key layout (most significant bits first):
+*   Opaque:      layer (4) | pass (4) | 0 | program (12) | texture set (11) | depth (32)
+*   Transparent: layer (4) | pass (4) | 1 | inverted depth (32) | program (12) | texture set (11)
+*   Front-to-back: layer (4) | pass (4) | 0 | depth (32) | program (12) | texture set (11)
+*
+* Opaque draws are thus grouped by program and sorted front-to-back, while transparent draws 
+* are sorted back-to-front. Front-to-back keys favour early depth rejection over state changes.
+*
+*/
+namespace vxr
+{
+
+  class RenderBucket
+  {
+  public:
+    RenderBucket();
+    ~RenderBucket();
+
+    static uint64 OpaqueKey(uint32 layer, uint32 pass, uint32 program, uint32 texture_set, float depth);
+    static uint64 TransparentKey(uint32 layer, uint32 pass, uint32 program, uint32 texture_set, float depth);
+    static uint64 FrontToBackKey(uint32 layer, uint32 pass, uint32 program, uint32 texture_set, float depth);
+
+    void clear();
+    void add(uint64 key, uint32 index);
+    void sort();
+
+    uint32 size() const;
+    uint32 index(uint32 i) const;
+    uint64 key(uint32 i) const;
+
+  private:
+    struct Entry
+    {
+      uint64 key;
+      uint32 index;
+    };
+
+    std::vector<Entry> entries_;
+    std::vector<Entry> scratch_;
+  };
+
+} /* end of vxr namespace */
\ No newline at end of file
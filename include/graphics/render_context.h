@@ -27,6 +27,8 @@
 #include "../../include/graphics/gpu_instances.h"
 #include "../engine/engine.h"
 
+#include <mutex>
+
 // ----------------------------------------------------------------------------------------
 //  The following structures and functions have been partially extracted from px_render.h 
 //  by Jose L. Hidalgo (PpluX), and later modified to fit vxr needs.
@@ -71,10 +73,23 @@ namespace vxr
     void init(const Params::GPU& params);
 
     // - Instances ----------------------------------------
-    scoped_array<gpu::BufferInstance>      buffers_;
-    scoped_array<gpu::TextureInstance>     textures_;
-    scoped_array<gpu::MaterialInstance>    materials_;
-    scoped_array<gpu::FramebufferInstance> framebuffers_;
+    paged_array<gpu::BufferInstance>      buffers_;
+    paged_array<gpu::TextureInstance>     textures_;
+    paged_array<gpu::MaterialInstance>    materials_;
+    paged_array<gpu::FramebufferInstance> framebuffers_;
+    // - Free Slots ---------------------------------------
+    gpu::FreeList free_buffers_;
+    gpu::FreeList free_textures_;
+    gpu::FreeList free_materials_;
+    gpu::FreeList free_framebuffers_;
+    // - Memory -------------------------------------------
+    struct Memory
+    {
+      std::atomic<uint64> bytes = { 0 };
+      std::atomic<uint64> peak_bytes = { 0 };
+    };
+    Memory buffer_memory_;
+    Memory texture_memory_;
     // - Render State -------------------------------------
     DisplayList::SetupMaterialData main_material = {};
     // - Back End -----------------------------------------
@@ -82,22 +97,69 @@ namespace vxr
 
   public:
     template<class T>
-    static bool CheckValidResource(uint32 id, const scoped_array<T> *pool) {
+    static bool CheckValidResource(uint32 id, const paged_array<T> *pool) {
       auto pv = indexAndVersion(id);
       uint32 pos = pv.first;
       uint32 version = pv.second;
+      if (pos >= pool->size())
+      {
+        return false;
+      }
       const T* result = &(*pool)[pos];
       uint32 real_version = (result->state.load() & 0xFFF);
 
       return real_version == version;
     }
 
+    // Takes a free slot of the pool, growing it if needed, and returns its new id (index + version).
+    // Returns 0 only if the pool reached the maximum number of resources an id can address.
+    template<class T>
+    uint32 AcquireResource(paged_array<T>* pool, gpu::FreeList* free_list, gpu::Resource::Type::Enum type) {
+      uint32 pos = free_list->pop();
+      while (pos == gpu::FreeList::kEmpty)
+      {
+        if (!grow(type))
+        {
+          return 0;
+        }
+        pos = free_list->pop();
+      }
+      T* result = &(*pool)[pos];
+      if (!result->acquire())
+      {
+        VXR_LOG(VXR_DEBUG_LEVEL_ERROR, "[ERROR]: [GPU] Free list returned a slot in use (%u).\n", pos);
+        return 0;
+      }
+      return pos | (result->version << 20);
+    }
+
+    // Invalidates the id and gives the slot back to the pool. Backend objects must be gone already.
+    template<class T>
+    static void ReleaseResource(uint32 id, paged_array<T>* pool, gpu::FreeList* free_list) {
+      if (!CheckValidResource(id, pool))
+      {
+        return;
+      }
+      uint32 pos = index(id);
+      (*pool)[pos].release();
+      free_list->push(pos);
+    }
+
+    // Sets the GPU memory used by a resource instance (0 once released) and updates the totals.
+    static void SetInstanceMemory(gpu::InstanceBase* instance, uint64 bytes, Memory* memory);
+    // Size of the texture storage, mipmaps add a third of the base level.
+    static uint64 TextureMemory(const gpu::TextureInstance& texture, bool mipmaps);
+
     static uint32 index(uint32 id);
     static std::pair<uint32, uint32> indexAndVersion(uint32 id);
 
   private:
+    // Adds a page to the instance pool, backend pool and free list of the given resource type.
+    bool grow(gpu::Resource::Type::Enum type);
+    std::mutex grow_mx_;
+
     template<class T, class B>
-    static std::pair<T*, B*> GetResource(uint32 id, scoped_array<T>* instance_array, scoped_array<B>* backend_array) {
+    static std::pair<T*, B*> GetResource(uint32 id, paged_array<T>* instance_array, paged_array<B>* backend_array) {
       if (CheckValidResource(id, instance_array))
       {
         uint32 i = index(id);
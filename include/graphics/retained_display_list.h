@@ -0,0 +1,85 @@
+#pragma once
+
+// ----------------------------------------------------------------------------------------
+// MIT License
+// 
+// Copyright(c) 2018 Vctor vila
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ----------------------------------------------------------------------------------------
+
+#include "display_list.h"
+
+#include <memory>
+
+/**
+* \file retained_display_list.h
+*
+* \author Victor Avila (avilapa.github.io)
+*
+* \brief Display List recorded once and submitted by reference every frame, for static content.
+*
+* Submitting a retained list only adds a reference to it to the frame, so its commands are 
+* neither rebuilt nor copied. Data referenced by FillBuffer and FillTexture commands is read
+* every time the list is executed, so it must outlive the recording.
+*
+*/
+namespace vxr
+{
+
+  class RetainedDisplayList : public Object
+  {
+    VXR_OBJECT(RetainedDisplayList, Object)
+    friend class DisplayList;
+  public:
+    RetainedDisplayList();
+    ~RetainedDisplayList();
+
+    /// Starts a new recording, replacing the previous one. Commands are added to the returned 
+    /// list until finish() is called. 'key' identifies the state the commands were built from.
+    DisplayList& record(uint64 key = 0);
+    /// Ends the recording. Returns false if any of the referenced resources is invalid.
+    bool finish();
+
+    /// A finished recording stays valid while every buffer, texture, material and framebuffer it 
+    /// references keeps the version it had when recorded.
+    bool valid() const;
+    void invalidate();
+
+    uint64 key() const;
+    uint32 num_commands() const;
+
+    /// Hashes the resources and state used by a material setup and its draw, so callers can tell
+    /// whether a recording would change (e.g. a texture was reloaded or a material recreated).
+    static uint64 Key(const DisplayList::SetupMaterialData& material, const DisplayList::RenderData& render);
+
+  private:
+    void track(const DisplayList& commands);
+    void track(const gpu::Resource& resource);
+
+    /// Shared with the frames in flight that reference it, so a new recording never modifies 
+    /// commands the render thread may be executing.
+    std::shared_ptr<DisplayList> commands_;
+    std::vector<gpu::Resource> resources_;
+    uint64 key_ = 0;
+    bool recording_ = false;
+    bool finished_ = false;
+  };
+
+} /* end of vxr namespace */
\ No newline at end of file
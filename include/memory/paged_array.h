@@ -0,0 +1,116 @@
+#pragma once
+
+// ----------------------------------------------------------------------------------------
+// MIT License
+// 
+// Copyright(c) 2018 Vctor vila
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ----------------------------------------------------------------------------------------
+
+#include <cassert>
+#include <atomic>
+
+/**
+* \file paged_array.h
+*
+* \author Victor Avila (avilapa.github.io)
+*
+* \brief Array that grows in fixed size pages. Elements never move, so references and indices 
+* stay valid while it grows, and other threads may keep reading existing elements meanwhile.
+*
+*/
+namespace vxr 
+{
+
+  template<class T, size_t kPageSize = 256, size_t kMaxElements = (1 << 20)> class paged_array {  // noncopyable
+  public:
+
+    typedef T element_type;
+
+    static const size_t kMaxPages = (kMaxElements + kPageSize - 1) / kPageSize;
+
+    paged_array() : size_(0) {
+      for (size_t i = 0; i < kMaxPages; ++i) {
+        pages_[i] = nullptr;
+      }
+    }
+
+    ~paged_array() {
+      release();
+    }
+
+    void alloc(size_t num_elements) {
+      release();
+      grow(num_elements);
+    }
+
+    void release() {
+      size_t num_pages = size_ / kPageSize;
+      for (size_t i = 0; i < num_pages; ++i) {
+        delete[] pages_[i].load(std::memory_order_relaxed);
+        pages_[i] = nullptr;
+      }
+      size_ = 0;
+    }
+
+    // Adds pages until at least 'num_elements' fit (up to kMaxElements) and returns the new size. 
+    // Calls to grow must be serialized by the caller, reads of existing elements may run concurrently.
+    size_t grow(size_t num_elements) {
+      if (num_elements > kMaxElements) {
+        num_elements = kMaxElements;
+      }
+      size_t size = size_.load(std::memory_order_relaxed);
+      while (size < num_elements) {
+        pages_[size / kPageSize].store(new T[kPageSize], std::memory_order_release);
+        size += kPageSize;
+        size_.store(size, std::memory_order_release);
+      }
+      return size;
+    }
+
+    T & operator[](const size_t i) const {
+      assert(i < size() && "Invalid index (overflow)");
+      return pages_[i / kPageSize].load(std::memory_order_acquire)[i % kPageSize];
+    }
+
+    // returns the number of elements
+    size_t size() const { return size_.load(std::memory_order_acquire); }
+
+    size_t num_pages() const { return size() / kPageSize; }
+
+    size_t sizeInBytes() const { return size() * sizeof(T); }
+
+    bool valid() const {
+      return size() != 0;
+    }
+
+    size_t max_size() const { return kMaxElements; }
+
+    static size_t page_size() { return kPageSize; }
+
+  private:
+    std::atomic<T*> pages_[kMaxPages];
+    std::atomic<size_t> size_;
+
+    explicit paged_array(paged_array const &);
+    paged_array & operator=(paged_array const &);
+  };
+
+} /* end of vxr namespace */
\ No newline at end of file
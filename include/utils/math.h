@@ -43,6 +43,12 @@ namespace vxr
     vec4 lerp(vec4 a, vec4 b, float alpha);
 
     float inverseLerp(float a, float b, float value);
+
+    // Composes 'count' transformations (translate * scale * rotate, as Transform::local_transform()) and
+    // multiplies them by their parent matrix (identity for roots): out[i] = parents[i] * local[i]. Every
+    // matrix is treated as affine, so only the upper 3x4 part is computed. Four at a time when VXR_SIMD
+    // is enabled, unless 'simd' is false (to compare both paths).
+    void composeTransforms(uint32 count, const vec3* positions, const quat* rotations, const vec3* scales, const mat4* const* parents, mat4* out, bool simd = true);
   }
 
 } /* end of vxr namespace */
\ No newline at end of file
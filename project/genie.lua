@@ -36,6 +36,11 @@ newoption {
 	description = "Set DirectX11 backend.",
 }
 
+newoption {
+	trigger = "null",
+	description = "Set Null (headless) backend.",
+}
+
 newoption {
 	trigger = "debug-tracing",
 	description = "Enable MTR tracing.",
@@ -80,6 +85,12 @@ solution "VXR-Engine"
 			"/wd4244",
 		}
 
+	configuration 		{ "linux" }
+		-- glm headers include "../../include/engine/ignore_warnings.h" relative to this directory.
+		includedirs 	{ path.join(PROJ_DIR, "deps/glm") }
+		buildoptions 	{ "-std=c++17" }
+		links 			{ "pthread" }
+
 	configuration "vs2015"
 		windowstargetplatformversion "8.1"
 
@@ -132,6 +143,9 @@ project "VXR"
 	if _OPTIONS["dx11"] 			then
 	defines 	{ "VXR_DX11", "UNICODE" }
 	end
+	if _OPTIONS["null"] 			then
+	defines 	{ "VXR_NULL" }
+	end
 
 	if _OPTIONS["debug-tracing"] 	then
 	includedirs { path.join(PROJ_DIR, "deps/minitrace/minitrace.h") }
@@ -181,4 +195,7 @@ makeProject("03-Framebuffers")
 makeProject("04-Mesh")
 makeProject("05-Materials")
 makeProject("06-Procedural")
-makeProject("07-Physics")
\ No newline at end of file
+makeProject("07-Physics")
+makeProject("08-Crowd")
+makeProject("09-Culling")
+makeProject("10-Transforms")
\ No newline at end of file
@@ -85,6 +85,12 @@ namespace vxr
     ImGui::Checkbox(uiText("##ClearSettingsDepth").c_str(), &clear_depth_);
     ImGui::Separator();
     ImGui::Spacing();
+    ImGui::Text("Depth Prepass"); ImGui::SameLine();
+    ImGui::Checkbox(uiText("##DepthPrepass").c_str(), &depth_prepass_);
+    ImGui::Text("Front To Back"); ImGui::SameLine();
+    ImGui::Checkbox(uiText("##FrontToBack").c_str(), &front_to_back_);
+    ImGui::Separator();
+    ImGui::Spacing();
     ImGui::Text("FOV        "); ImGui::SameLine();
     if (ImGui::DragFloat(uiText("##Fov").c_str(), &fov_, 0.1f, -FLT_MAX, FLT_MAX)) dirty_ = true;
     ImGui::Text("Near Plane "); ImGui::SameLine();
@@ -115,7 +121,13 @@ namespace vxr
   {
     VXR_TRACE_SCOPE("VXR", "Compute Transformations");
     projection_ = glm::perspective(glm::radians(fov_), aspect_, near_plane_, far_plane_);
-    view_ = glm::lookAt(transform()->world_position(), transform()->world_position() + transform()->world_forward(), transform()->world_up());
+    // The view follows the render matrix, so it is interpolated along with everything else.
+    const mat4& world = *transform()->render_matrix();
+    const vec3 position = vec3(world[3]);
+    const vec3 forward = glm::normalize(vec3(world * vec4(kWorldForward, 0.0f)));
+    const vec3 up = glm::normalize(vec3(world * vec4(kWorldUp, 0.0f)));
+    view_ = glm::lookAt(position, position + forward, up);
+    transform_version_ = transform()->render_version();
     dirty_ = false;
   }
 
@@ -249,7 +261,9 @@ namespace vxr
     main_->composer()->setupFirstPass();
 
     DisplayList frame;
-    if (main_->hasChanged() || main_->transform()->hasChanged())
+    // The transform system brings the render matrices up to date first, so their version tells whether
+    // the camera moved since the view was computed.
+    if (main_->hasChanged() || main_->transform()->hasChanged() || main_->transform()->render_version() != main_->transform_version_)
     {
       main_->computeTransformations();
     }
@@ -259,7 +273,7 @@ namespace vxr
     common_uniforms_.data.u_resolution = Engine::ref().window()->params().size;
     /// TODO: Fill xy.
     common_uniforms_.data.u_clear_color = main_->background_color().rgba();
-    common_uniforms_.data.u_view_pos_num_lights = vec4(main_->transform()->world_position(), (float)Engine::ref().light()->num_lights());
+    common_uniforms_.data.u_view_pos_num_lights = vec4(vec3((*main_->transform()->render_matrix())[3]), (float)Engine::ref().light()->num_light_slots());
 
     /// TODO: Move this into a different constant update buffer OR update this every frame as doing now.
     common_uniforms_.data.u_time = vec4(Engine::ref().window()->uptime(), 0, 0, 0);
@@ -274,6 +274,8 @@ namespace vxr
       frame.renderCommand()
         .set_index_buffer(Engine::ref().assetManager()->default_cube()->indexBuffer())
         .set_count(Engine::ref().assetManager()->default_cube()->indexCount())
+        .set_offset(Engine::ref().assetManager()->default_cube()->indexOffset())
+        .set_base_vertex(Engine::ref().assetManager()->default_cube()->baseVertex())
         .set_type(Engine::ref().assetManager()->default_cube()->indexFormat());
     }
 
@@ -333,6 +335,8 @@ namespace vxr
       frame.renderCommand()
         .set_index_buffer(Engine::ref().assetManager()->default_cube()->indexBuffer())
         .set_count(Engine::ref().assetManager()->default_cube()->indexCount())
+        .set_offset(Engine::ref().assetManager()->default_cube()->indexOffset())
+        .set_base_vertex(Engine::ref().assetManager()->default_cube()->baseVertex())
         .set_type(Engine::ref().assetManager()->default_cube()->indexFormat());
     }
     Engine::ref().submitDisplayList(std::move(frame));
@@ -399,6 +403,8 @@ namespace vxr
         frame.renderCommand()
           .set_index_buffer(Engine::ref().assetManager()->default_cube()->indexBuffer())
           .set_count(Engine::ref().assetManager()->default_cube()->indexCount())
+          .set_offset(Engine::ref().assetManager()->default_cube()->indexOffset())
+          .set_base_vertex(Engine::ref().assetManager()->default_cube()->baseVertex())
           .set_type(Engine::ref().assetManager()->default_cube()->indexFormat());
       }
     }
@@ -442,6 +448,8 @@ namespace vxr
     frame.renderCommand()
       .set_index_buffer(Engine::ref().assetManager()->default_quad()->indexBuffer())
       .set_count(Engine::ref().assetManager()->default_quad()->indexCount())
+      .set_offset(Engine::ref().assetManager()->default_quad()->indexOffset())
+      .set_base_vertex(Engine::ref().assetManager()->default_quad()->baseVertex())
       .set_type(Engine::ref().assetManager()->default_quad()->indexFormat());
     Engine::ref().submitDisplayList(std::move(frame));
     main_->initialization_level_++;
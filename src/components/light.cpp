@@ -24,11 +24,14 @@
 
 #include "../../include/components/light.h"
 
+#include "../../include/components/camera.h"
 #include "../../include/engine/engine.h"
 #include "../../include/engine/gpu.h"
 #include "../../include/core/gameobject.h"
 #include "../../include/core/scene.h"
 
+#include <algorithm>
+
 namespace vxr 
 {
 
@@ -63,14 +66,15 @@ namespace vxr
     }
     ImGui::Text(((contributes_) ? "YES" : "NO"));
     ImGui::PopStyleColor();
+    bool changed = false;
     ImGui::Spacing();
     ImGui::Text("Type         "); ImGui::SameLine();
-    ImGui::Combo(uiText("##Type").c_str(), (int*)&type_, "Punctual\0Directional\0\0");
+    changed |= ImGui::Combo(uiText("##Type").c_str(), (int*)&type_, "Punctual\0Directional\0\0");
     ImGui::Spacing();
     ImGui::Text("Ambient      "); ImGui::SameLine();
-    ImGui::DragFloat(uiText("##Ambient").c_str(), &ambient_, 0.01f, -FLT_MAX, FLT_MAX);///
+    changed |= ImGui::DragFloat(uiText("##Ambient").c_str(), &ambient_, 0.01f, -FLT_MAX, FLT_MAX);///
     ImGui::Text("Intensity    "); ImGui::SameLine();
-    ImGui::DragFloat(uiText("##Intensity").c_str(), &intensity_, 0.01f, -FLT_MAX, FLT_MAX);
+    changed |= ImGui::DragFloat(uiText("##Intensity").c_str(), &intensity_, 0.01f, -FLT_MAX, FLT_MAX);
     ImGui::Spacing();
     switch (type_)
     {
@@ -78,39 +82,48 @@ namespace vxr
       break;
     case Type::Punctual:
       ImGui::Text("Falloff      "); ImGui::SameLine();
-      ImGui::DragFloat(uiText("##Falloff").c_str(), &falloff_, 0.01f, -FLT_MAX, FLT_MAX);
+      changed |= ImGui::DragFloat(uiText("##Falloff").c_str(), &falloff_, 0.01f, -FLT_MAX, FLT_MAX);
       ImGui::Text("Cone Angle   "); ImGui::SameLine();
-      ImGui::DragFloat(uiText("##Cone Angle").c_str(), &cone_angle_, 1.0f, -FLT_MAX, FLT_MAX);
+      changed |= ImGui::DragFloat(uiText("##Cone Angle").c_str(), &cone_angle_, 1.0f, -FLT_MAX, FLT_MAX);
       break;
     }
     ImGui::Spacing();
     ImGui::Text("Light Color  "); ImGui::SameLine();
-    ImGui::ColorEdit3(uiText("##Color").c_str(), (float*)&color_);
+    changed |= ImGui::ColorEdit3(uiText("##Color").c_str(), (float*)&color_);
+    if (changed)
+    {
+      version_++;
+    }
   }
 
   void Light::set_type(Type::Enum type)
   {
     type_ = type;
+    version_++;
   }
 
   void Light::set_color(const Color& color)
   {
     color_ = color;
+    version_++;
   }
 
   void Light::set_intensity(const float& intensity)
   {
     intensity_ = intensity;
+    version_++;
   }
 
   void Light::set_ambient(const float& ambient)
   {
     ambient_ = ambient;
+    version_++;
   }
 
   void Light::set_falloff(const float& falloff)
   {
     falloff_ = falloff;
+    version_++;
   }
 
   System::Light::Light()
@@ -127,44 +140,255 @@ namespace vxr
       sizeof(light_uniforms_.data), 
       Usage::Static, 
       "Lights" });
+    cluster_uniforms_.buffer = Engine::ref().gpu()->createBuffer({ BufferType::Uniform,
+      sizeof(cluster_uniforms_.data),
+      Usage::Static,
+      "LightClusters" });
+    index_uniforms_.buffer = Engine::ref().gpu()->createBuffer({ BufferType::Uniform,
+      sizeof(index_uniforms_.data),
+      Usage::Static,
+      "LightIndices" });
+    // The whole block is uploaded once, then only the slots that change.
+    dirty_begin_ = 0;
+    dirty_end_ = kMaxLightSources;
   }
 
+  static const uint32 kLightsPerChunk = 256;
+
   void System::Light::renderPreUpdate()
   {
     VXR_TRACE_SCOPE("VXR", "Light Render Pre Update");
+    scene_id_ = scene_->id();
+    const uint32 num_chunks = ((uint32)components_.size() + kLightsPerChunk - 1) / kLightsPerChunk;
+    if (chunks_.size() < num_chunks)
+    {
+      chunks_.resize(num_chunks);
+    }
+    Engine::ref().runParallel(num_chunks, [this](uint32 i) { gather(i); });
+
+    // Lights that kept their slot are repacked only if they changed, the rest are given one below.
+    frame_++;
+    pending_.clear();
     num_lights_ = 0;
-    for (auto &c : components_)
+    for (uint32 i = 0; i < num_chunks; ++i)
     {
-      if (scene_->id() != c->gameObject()->scene_id() || !c->gameObject()->active())
+      Chunk& chunk = chunks_[i];
+      for (uint32 c : chunk.deferred)
       {
-        c->contributes_ = false;
-        continue;
+        chunk.sources.push_back(source(c));
+      }
+      // Deferred lights are appended after the rest, restore the component order.
+      if (!chunk.deferred.empty())
+      {
+        std::sort(chunk.sources.begin(), chunk.sources.end(), [](const Source& a, const Source& b) { return a.component < b.component; });
       }
 
-      if (num_lights_ < kMaxLightSources)
+      for (const Source& s : chunk.sources)
       {
-        c->contributes_ = true;
-        /// Will need transformations for shadows
-        /*if (c->hasChanged())
+        vxr::Light* c = components_[s.component].get();
+        if (!owns(c))
         {
-          c->computeTransformations();
-        }*/
+          pending_.push_back(s);
+          continue;
+        }
+        slot_frame_[c->slot_] = frame_;
+        if (s.changed)
+        {
+          pack(c->slot_, s);
+        }
+        c->contributes_ = true;
+        num_lights_++;
+      }
+    }
 
-        light_uniforms_.data.position_falloff[num_lights_] = vec4(c->transform()->world_position(), (c->type_ == vxr::Light::Type::Directional) ? 0.0f : c->falloff_);
-        light_uniforms_.data.color_intensity[num_lights_] = vec4(c->color_.rgb(), c->intensity_);
-        light_uniforms_.data.direction_ambient[num_lights_] = vec4(c->transform()->world_rotation_angles(), c->ambient_);
+    // Slots of the lights not gathered this frame (inactive, removed or from another scene) are released.
+    for (uint32 i = 0; i < num_slots_; ++i)
+    {
+      if (slot_owner_[i] && slot_frame_[i] != frame_)
+      {
+        release(i);
+      }
+    }
 
-        num_lights_++;
+    // Pending lights are given the first free slots in component order, the ones left do not contribute.
+    uint32 free_slot = 0;
+    for (const Source& s : pending_)
+    {
+      vxr::Light* c = components_[s.component].get();
+      while (free_slot < kMaxLightSources && slot_owner_[free_slot])
+      {
+        free_slot++;
       }
+      c->contributes_ = free_slot < kMaxLightSources;
+      if (!c->contributes_)
+      {
+        c->slot_ = -1;
+        continue;
+      }
+      c->slot_ = (int32)free_slot;
+      slot_owner_[free_slot] = c;
+      slot_frame_[free_slot] = frame_;
+      pack(free_slot, s);
+      num_lights_++;
+    }
+
+    num_slots_ = 0;
+    directional_.clear();
+    punctual_.clear();
+    for (uint32 i = 0; i < kMaxLightSources; ++i)
+    {
+      if (slot_owner_[i])
+      {
+        num_slots_ = i + 1;
+        if (light_uniforms_.data.position_falloff[i].w == 0.0f)
+        {
+          directional_.push_back((uint8)i);
+        }
+        else
+        {
+          punctual_.push_back((uint8)i);
+        }
+      }
+    }
 
+    if (dirty_begin_ >= dirty_end_)
+    {
+      return;
     }
 
+    // Each array of the light data gets the changed range of slots.
+    const uint32 offset = dirty_begin_ * sizeof(vec4);
+    const uint32 size = (dirty_end_ - dirty_begin_) * sizeof(vec4);
     DisplayList frame;
     frame.fillBufferCommand()
       .set_buffer(light_uniforms_.buffer)
-      .set_data(&light_uniforms_.data)
-      .set_size(sizeof(light_uniforms_.data));
+      .set_data(&light_uniforms_.data.position_falloff[dirty_begin_])
+      .set_offset(offsetof(Shader::LightData, position_falloff) + offset)
+      .set_size(size);
+    frame.fillBufferCommand()
+      .set_buffer(light_uniforms_.buffer)
+      .set_data(&light_uniforms_.data.color_intensity[dirty_begin_])
+      .set_offset(offsetof(Shader::LightData, color_intensity) + offset)
+      .set_size(size);
+    frame.fillBufferCommand()
+      .set_buffer(light_uniforms_.buffer)
+      .set_data(&light_uniforms_.data.direction_ambient[dirty_begin_])
+      .set_offset(offsetof(Shader::LightData, direction_ambient) + offset)
+      .set_size(size);
     Engine::ref().submitDisplayList(std::move(frame));
+    dirty_begin_ = dirty_end_ = 0;
+  }
+
+  void System::Light::renderUpdate()
+  {
+    ref_ptr<vxr::Camera> camera = Engine::ref().camera()->main();
+    if (!camera)
+    {
+      return;
+    }
+
+    VXR_TRACE_SCOPE("VXR", "Light Render Update");
+    clusters_.setup(camera->projection(), camera->near_plane(), camera->far_plane());
+    clusters_.begin(camera->view(), light_uniforms_.data, punctual_.data(), (uint32)punctual_.size());
+    Engine::ref().runParallel(clusters_.num_slices(), [this](uint32 slice) { clusters_.bin(slice); });
+
+    const bool fits = clusters_.compact(directional_.data(), (uint32)directional_.size(), &cluster_uniforms_.data, &index_uniforms_.data);
+    if (!fits && !clusters_overflow_)
+    {
+      VXR_LOG(VXR_DEBUG_LEVEL_WARNING, "[WARNING]: [LIGHT] Too many lights per cluster, some will not be evaluated (max %d light indices).\n", (int)kMaxLightClusterIndices);
+    }
+    clusters_overflow_ = !fits;
+    cluster_uniforms_.data.params.z = (float)directional_.size();
+
+    // Only the used part of the index lists is uploaded.
+    DisplayList frame;
+    frame.fillBufferCommand()
+      .set_buffer(cluster_uniforms_.buffer)
+      .set_data(&cluster_uniforms_.data)
+      .set_size(sizeof(cluster_uniforms_.data));
+    frame.fillBufferCommand()
+      .set_buffer(index_uniforms_.buffer)
+      .set_data(&index_uniforms_.data)
+      .set_size(glm::max((clusters_.num_indices() + 15) & ~15u, 16u));
+    Engine::ref().submitDisplayList(std::move(frame));
+  }
+
+  void System::Light::gather(uint32 chunk_index)
+  {
+    VXR_TRACE_SCOPE("VXR", "Gather Lights");
+    Chunk& chunk = chunks_[chunk_index];
+    chunk.sources.clear();
+    chunk.deferred.clear();
+
+    const uint32 begin = chunk_index * kLightsPerChunk;
+    const uint32 end = glm::min(begin + kLightsPerChunk, (uint32)components_.size());
+    for (uint32 i = begin; i < end; ++i)
+    {
+      vxr::Light* c = components_[i].get();
+      if (scene_id_ != c->gameObject()->scene_id() || !c->gameObject()->active())
+      {
+        c->contributes_ = false;
+        continue;
+      }
+
+      // Updating a transform may update its parents too, which can be shared with other chunks.
+      if (c->transform()->hasChanged())
+      {
+        chunk.deferred.push_back(i);
+        continue;
+      }
+
+      /// Will need transformations for shadows
+      /*if (c->hasChanged())
+      {
+        c->computeTransformations();
+      }*/
+      chunk.sources.push_back(source(i));
+    }
+  }
+
+  System::Light::Source System::Light::source(uint32 component)
+  {
+    vxr::Light* c = components_[component].get();
+    const vec3& position = c->transform()->world_position();
+    const uint32 transform_version = c->transform()->version();
+    Source s;
+    s.component = component;
+    s.changed = !owns(c) || c->version_ != c->packed_version_ || transform_version != c->packed_transform_version_;
+    if (s.changed)
+    {
+      s.position_falloff = vec4(position, (c->type_ == vxr::Light::Type::Directional) ? 0.0f : c->falloff_);
+      s.color_intensity = vec4(c->color_.rgb(), c->intensity_);
+      s.direction_ambient = vec4(c->transform()->world_rotation_angles(), c->ambient_);
+      c->packed_version_ = c->version_;
+      c->packed_transform_version_ = transform_version;
+    }
+    return s;
+  }
+
+  bool System::Light::owns(const vxr::Light* c) const
+  {
+    return c->slot_ >= 0 && slot_owner_[c->slot_] == c;
+  }
+
+  void System::Light::pack(uint32 slot, const Source& s)
+  {
+    light_uniforms_.data.position_falloff[slot] = s.position_falloff;
+    light_uniforms_.data.color_intensity[slot] = s.color_intensity;
+    light_uniforms_.data.direction_ambient[slot] = s.direction_ambient;
+    dirty_begin_ = (dirty_begin_ < dirty_end_) ? glm::min(dirty_begin_, slot) : slot;
+    dirty_end_ = glm::max(dirty_end_, slot + 1);
+  }
+
+  void System::Light::release(uint32 slot)
+  {
+    // Cleared slots read as directional lights without color, so loops over every slot skip them.
+    slot_owner_[slot] = nullptr;
+    Source s;
+    s.position_falloff = vec4(0.0f);
+    s.color_intensity = vec4(0.0f);
+    s.direction_ambient = vec4(0.0f);
+    pack(slot, s);
   }
 
   uint32 System::Light::num_lights() const
@@ -172,11 +396,26 @@ namespace vxr
     return num_lights_;
   }
 
+  uint32 System::Light::num_light_slots() const
+  {
+    return num_slots_;
+  }
+
   gpu::Buffer System::Light::light_uniforms_buffer() const
   {
     return light_uniforms_.buffer;
   }
 
+  gpu::Buffer System::Light::light_clusters_buffer() const
+  {
+    return cluster_uniforms_.buffer;
+  }
+
+  gpu::Buffer System::Light::light_indices_buffer() const
+  {
+    return index_uniforms_.buffer;
+  }
+
   ref_ptr<System::Light> System::Getter<Light>::get()
   {
     return Engine::ref().light();
@@ -47,6 +47,13 @@ namespace vxr
       mesh->onGUI();
       ImGui::TreePop();
     }
+
+    if (lod.valid() && ImGui::TreeNodeEx((void*)(intptr_t)lod->id(), 0, "Levels of Detail"))
+    {
+      ImGui::Spacing();
+      lod->onGUI();
+      ImGui::TreePop();
+    }
   }
 
   System::MeshFilter::MeshFilter()
@@ -27,10 +27,13 @@
 #include "../../include/components/mesh_filter.h"
 #include "../../include/components/light.h"
 #include "../../include/engine/engine.h"
+#include "../../include/engine/gpu.h"
 #include "../../include/core/gameobject.h"
 #include "../../include/core/scene.h"
 #include "../../include/graphics/materials/material.h"
 
+#include <algorithm>
+
 namespace vxr 
 {
 
@@ -51,6 +54,31 @@ namespace vxr
       material->onGUI();
       ImGui::TreePop();
     }
+    ImGui::Text("Occluder "); ImGui::SameLine();
+    ImGui::Checkbox(uiText("##Occluder").c_str(), &occluder);
+    ImGui::Text("Occludee "); ImGui::SameLine();
+    ImGui::Checkbox(uiText("##Occludee").c_str(), &occludee);
+  }
+
+  static const uint32 kDrawsPerChunk = 256;
+  static const uint32 kProxiesPerChunk = 1024;
+  // Relative margin around the screen size thresholds of the levels of detail, so that objects near a
+  // threshold do not switch levels every frame.
+  static const float kLODHysteresis = 0.1f;
+  static const uint32 kNoLOD = 0xFFFFFFFF;
+  // Resolution of the CPU occlusion buffer.
+  static const uint32 kOcclusionWidth = 256;
+  static const uint32 kOcclusionHeight = 128;
+
+  // Small hash of the texture handles, only used to group draws in the sort key.
+  static uint32 TextureSetHash(const gpu::Texture* textures, uint32 count)
+  {
+    uint32 hash = 2166136261u;
+    for (uint32 i = 0; i < count; ++i)
+    {
+      hash = (hash ^ textures[i].id) * 16777619u;
+    }
+    return hash ^ (hash >> 11) ^ (hash >> 22);
   }
 
   System::Renderer::Renderer()
@@ -64,25 +92,146 @@ namespace vxr
   void System::Renderer::renderUpdate()
   {
     VXR_TRACE_SCOPE("VXR", "Renderer Render Update");
+    draws_.clear();
+    opaque_.clear();
     transparent_.clear();
+    prepass_.clear();
+    const size_t draw_uniforms_capacity = draw_uniforms_ ? draw_uniforms_->capacity() : 0;
+    draw_uniforms_ = std::make_shared<std::vector<uint8>>();
+    draw_uniforms_->reserve(draw_uniforms_capacity);
+    draw_uniforms_offsets_.clear();
 
-    DisplayList frame;
-    for (auto &c : components_)
+    vec3 eye = vec3(0.0f);
+    ref_ptr<vxr::Camera> camera = Engine::ref().camera()->main();
+    depth_prepass_ = false;
+    front_to_back_ = false;
+    if (camera != nullptr)
     {
-      // Check if the object has to be rendered.
-      if (setup(c))
+      // Same eye the frame is drawn from, which may be interpolated between logic steps.
+      eye = vec3((*camera->transform()->render_matrix())[3]);
+      depth_prepass_ = camera->depth_prepass();
+      front_to_back_ = camera->front_to_back();
+    }
+
+    common_uniforms_buffer_ = Engine::ref().camera()->common_uniforms_buffer();
+    light_uniforms_buffer_ = Engine::ref().light()->light_uniforms_buffer();
+    light_clusters_buffer_ = Engine::ref().light()->light_clusters_buffer();
+    light_indices_buffer_ = Engine::ref().light()->light_indices_buffer();
+
+    // Compact the geometry arena before capturing, so that the mesh ranges stay put until the next frame.
+    Engine::ref().gpu()->meshArena()->defragment();
+
+    // Proxies are created along with the components and only rebuilt when their sources change.
+    while (proxies_.size() < components_.size())
+    {
+      Proxy proxy = {};
+      proxy.object = components_[proxies_.size()]->gameObject().get();
+      proxies_.push_back(proxy);
+    }
+
+    Frustum frustum;
+    mat4 view_projection = mat4(1.0f);
+    lod_scale_ = 0.0f;
+    if (camera != nullptr)
+    {
+      view_projection = camera->projection() * camera->view();
+      frustum.set(view_projection);
+      lod_clip_w_ = vec4(view_projection[0][3], view_projection[1][3], view_projection[2][3], view_projection[3][3]);
+      lod_scale_ = camera->projection()[1][1];
+    }
+    scene_id_ = scene_->id();
+    arena_generation_ = Engine::ref().gpu()->meshArena()->generation();
+
+    // Proxies are checked and culled in chunks on the scheduler workers...
+    const uint32 num_chunks = ((uint32)proxies_.size() + kProxiesPerChunk - 1) / kProxiesPerChunk;
+    if (chunks_.size() < num_chunks)
+    {
+      chunks_.resize(num_chunks);
+    }
+    const Frustum* cull_frustum = (camera != nullptr) ? &frustum : nullptr;
+    Engine::ref().runParallel(num_chunks, [this, cull_frustum](uint32 i) { prepare(i, cull_frustum); });
+
+    // ...but the ones whose sources changed are rebuilt here, as building sets up resources.
+    for (uint32 i = 0; i < num_chunks; ++i)
+    {
+      Chunk& chunk = chunks_[i];
+      for (uint32 p : chunk.stale)
       {
-        if (c->material->sharedMaterial()->gpu_.info.blend.enabled)
+        Proxy& proxy = proxies_[p];
+        if (!build(components_[p].get(), &proxy))
         {
-          transparent_.push_back(c);
           continue;
         }
 
-        // Send render commands.
-        render(c, &frame);
+        chunk.num_candidates++;
+        if (!cull_frustum || cull_frustum->test(proxy.center, proxy.extents))
+        {
+          chunk.visible.push_back(p);
+        }
       }
     }
-    Engine::ref().submitDisplayList(std::move(frame));
+
+    if (camera != nullptr)
+    {
+      occlude(view_projection, num_chunks);
+    }
+
+    num_candidates_ = 0;
+    num_visible_ = 0;
+    num_occluded_ = 0;
+    uint32 num_draws = 0;
+    for (uint32 i = 0; i < num_chunks; ++i)
+    {
+      Chunk& chunk = chunks_[i];
+      chunk.first_draw = num_draws;
+      num_draws += (uint32)chunk.visible.size();
+      num_candidates_ += chunk.num_candidates;
+      num_visible_ += (uint32)chunk.visible.size();
+      num_occluded_ += chunk.num_occluded;
+    }
+
+    // Visible proxies are captured in parallel too, each chunk into its own range of draws.
+    draws_.resize(num_draws);
+    Engine::ref().runParallel(num_chunks, [this, &eye](uint32 i)
+    {
+      const Chunk& chunk = chunks_[i];
+      for (uint32 j = 0; j < chunk.visible.size(); ++j)
+      {
+        capture(&proxies_[chunk.visible[j]], eye, &draws_[chunk.first_draw + j]);
+      }
+    });
+
+    batches_.clear();
+    for (uint32 index = 0; index < num_draws; ++index)
+    {
+      const Draw& draw = draws_[index];
+      if (draw.transparent)
+      {
+        queue(index, &transparent_);
+      }
+      else if (draw.instanced_material.id)
+      {
+        batches_.push_back({ BatchKey(draw), index });
+      }
+      else
+      {
+        queue(index, &opaque_);
+      }
+    }
+
+    batch();
+    uploadUniforms();
+
+    // The depth of the opaque objects is laid down first, front-to-back, when the camera asks for it...
+    if (prepass_.size())
+    {
+      prepass_.sort();
+      submit(prepass_, true);
+    }
+
+    // ...then they are grouped by program and drawn front-to-back.
+    opaque_.sort();
+    submit(opaque_, false);
   }
 
   void System::Renderer::renderPostUpdate()
@@ -99,13 +248,9 @@ namespace vxr
       return;
     }
 
-    DisplayList frame;
-    for (auto &c : transparent_) /// Need to sort the transparent objects.
-    {
-      // Send render commands.
-      render(c, &frame);
-    }
-    Engine::ref().submitDisplayList(std::move(frame));
+    // Transparent objects are drawn back-to-front.
+    transparent_.sort();
+    submit(transparent_, false);
 
     if (!scene_->skybox())
     {
@@ -119,23 +264,182 @@ namespace vxr
   }
 
 
-  bool System::Renderer::setup(ref_ptr<vxr::Renderer> c)
+  uint32 System::Renderer::num_visible() const
   {
-    VXR_TRACE_SCOPE("VXR", "Setup");
+    return num_visible_;
+  }
 
-    /// TODO: This should be checked once in Transform System and other Systems should read from a 'screenData' vector.
-    if (scene_->id() != c->gameObject()->scene_id() || !c->gameObject()->active())
+  uint32 System::Renderer::num_culled() const
+  {
+    return num_candidates_ - num_visible_ - num_occluded_;
+  }
+
+  uint32 System::Renderer::num_occluded() const
+  {
+    return num_occluded_;
+  }
+
+  void System::Renderer::prepare(uint32 chunk_index, const Frustum* frustum)
+  {
+    VXR_TRACE_SCOPE("VXR", "Prepare Renderers");
+    Chunk& chunk = chunks_[chunk_index];
+    chunk.stale.clear();
+    chunk.candidates.clear();
+    chunk.visible.clear();
+    chunk.num_occluded = 0;
+    chunk.culler.clear();
+
+    const uint32 begin = chunk_index * kProxiesPerChunk;
+    const uint32 end = glm::min(begin + kProxiesPerChunk, (uint32)proxies_.size());
+    for (uint32 i = begin; i < end; ++i)
     {
-      return false;
+      // Check if the object has to be rendered.
+      Proxy& proxy = proxies_[i];
+      /// TODO: This should be checked once in Transform System and other Systems should read from a 'screenData' vector.
+      if (scene_id_ != proxy.object->scene_id() || !proxy.object->active())
+      {
+        continue;
+      }
+
+      if (changed(components_[i].get(), proxy))
+      {
+        chunk.stale.push_back(i);
+        continue;
+      }
+
+      if (*proxy.world_version != proxy.bounds_version)
+      {
+        proxy.bounds.transform(*proxy.world, &proxy.center, &proxy.extents);
+        proxy.bounds_version = *proxy.world_version;
+      }
+      chunk.culler.add(proxy.center, proxy.extents);
+      chunk.candidates.push_back(i);
     }
+    chunk.num_candidates = (uint32)chunk.candidates.size();
 
-    ref_ptr<vxr::MeshFilter> mesh_component = c->getComponent<vxr::MeshFilter>();
-    if (!mesh_component)
+    if (frustum)
     {
-      return false;
+      chunk.culler.cull(*frustum, &chunk.visible);
+      for (uint32& v : chunk.visible)
+      {
+        v = chunk.candidates[v];
+      }
+    }
+    else
+    {
+      chunk.visible = chunk.candidates;
+    }
+  }
+
+  void System::Renderer::occlude(const mat4& view_projection, uint32 num_chunks)
+  {
+    VXR_TRACE_SCOPE("VXR", "Occlusion Culling");
+    if (occlusion_.width() == 0)
+    {
+      occlusion_.resize(kOcclusionWidth, kOcclusionHeight);
+    }
+
+    // Only occluders inside the frustum are rasterized, in component order.
+    occlusion_.begin(view_projection);
+    for (uint32 i = 0; i < num_chunks; ++i)
+    {
+      for (uint32 p : chunks_[i].visible)
+      {
+        const Proxy& proxy = proxies_[p];
+        if (proxy.occluder_mesh)
+        {
+          occlusion_.addOccluder(*proxy.world, proxy.occluder_mesh->vertices(), proxy.occluder_mesh->indices());
+        }
+      }
+    }
+    if (occlusion_.num_triangles() == 0)
+    {
+      return;
+    }
+
+    // Bands of tiles are rasterized in parallel, then the chunks test their own occludees.
+    Engine::ref().runParallel(occlusion_.num_bands(), [this](uint32 band) { occlusion_.rasterize(band); });
+    Engine::ref().runParallel(num_chunks, [this](uint32 i)
+    {
+      Chunk& chunk = chunks_[i];
+      uint32 count = 0;
+      for (uint32 p : chunk.visible)
+      {
+        const Proxy& proxy = proxies_[p];
+        if (proxy.occludee)
+        {
+          if (occlusion_.occluded(proxy.center, proxy.extents))
+          {
+            continue;
+          }
+        }
+        chunk.visible[count++] = p;
+      }
+      chunk.num_occluded = (uint32)chunk.visible.size() - count;
+      chunk.visible.resize(count);
+    });
+  }
+
+  bool System::Renderer::changed(vxr::Renderer* c, const Proxy& proxy) const
+  {
+    if (!proxy.valid)
+    {
+      return true;
+    }
+
+    const mat::MaterialInstance* material = c->material.get();
+    if (!material || material->id() != proxy.material_id || material->version() != proxy.material_version ||
+        proxy.shared_material->version() != proxy.shared_material_version)
+    {
+      return true;
+    }
+
+    Mesh* mesh = proxy.mesh_filter->mesh.get();
+    if (!mesh || mesh->id() != proxy.mesh_id || mesh->version() != proxy.mesh_version || mesh->hasChanged() ||
+        arena_generation_ != proxy.arena_generation)
+    {
+      return true;
+    }
+
+    const MeshLOD* lod = proxy.mesh_filter->lod.get();
+    if ((lod ? lod->id() : kNoLOD) != proxy.lod_id || (lod && lod->version() != proxy.lod_version))
+    {
+      return true;
+    }
+
+    if (c->occluder != proxy.occluder || c->occludee != proxy.occludee)
+    {
+      return true;
+    }
+
+    for (uint32 i = 0; i < proxy.num_textures; ++i)
+    {
+      if (proxy.texture_sources[i] && proxy.texture_sources[i]->hasChanged())
+      {
+        return true;
+      }
     }
 
-    ref_ptr<Mesh> mesh = mesh_component->mesh;
+    return false;
+  }
+
+  bool System::Renderer::build(vxr::Renderer* c, Proxy* proxy)
+  {
+    VXR_TRACE_SCOPE("VXR", "Build Render Proxy");
+    proxy->valid = false;
+
+    // Components are never removed, so the mesh filter only has to be found once.
+    if (!proxy->mesh_filter)
+    {
+      ref_ptr<vxr::MeshFilter> mesh_component = c->getComponent<vxr::MeshFilter>();
+      if (!mesh_component)
+      {
+        return false;
+      }
+      proxy->mesh_filter = mesh_component.get();
+    }
+
+    ref_ptr<Mesh> mesh = proxy->mesh_filter->mesh;
     if (!mesh)
     {
       return false;
@@ -162,43 +466,416 @@ namespace vxr
       return false;
     }
 
+    proxy->shared_material = shared_material.get();
+    proxy->material_id = c->material->id();
+    proxy->material_version = c->material->version();
+    proxy->shared_material_version = shared_material->version();
+    proxy->mesh_id = mesh->id();
+    proxy->mesh_version = mesh->version();
+    proxy->arena_generation = arena_generation_;
+
+    proxy->material = shared_material->material();
+    proxy->instanced_material = shared_material->instancedMaterial();
+    proxy->equal_material = shared_material->equalDepthMaterial();
+    proxy->equal_instanced_material = shared_material->equalDepthInstancedMaterial();
+    proxy->cull = shared_material->gpu_.info.cull;
+    proxy->lods[0] = { mesh->vertexBuffer(), mesh->indexBuffer(), mesh->indexCount(), mesh->indexOffset(), mesh->baseVertex(), mesh->indexFormat(), 0.0f };
+    proxy->num_lods = 1;
+    proxy->bounds = mesh->bounds();
+
+    // Chains are generated on a worker, their version changes (rebuilding the proxy) once they can be built.
+    MeshLOD* lod = proxy->mesh_filter->lod.get();
+    proxy->lod_id = lod ? lod->id() : kNoLOD;
+    proxy->lod_version = lod ? lod->version() : 0;
+    const Mesh* coarsest = mesh.get();
+    if (lod && lod->source() == mesh && lod->build())
+    {
+      for (uint32 i = 1; i < lod->num_levels(); ++i)
+      {
+        ref_ptr<Mesh> level = lod->level(i);
+        if (!level->setup())
+        {
+          break;
+        }
+        coarsest = level.get();
+        proxy->lods[i] = { level->vertexBuffer(), level->indexBuffer(), level->indexCount(), level->indexOffset(), level->baseVertex(), level->indexFormat(), lod->screen_size(i) };
+        proxy->num_lods++;
+      }
+    }
+    proxy->lod = glm::min(proxy->lod, proxy->num_lods - 1);
+    proxy->transparent = shared_material->gpu_.info.blend.enabled;
+    proxy->occluder = c->occluder;
+    proxy->occludee = c->occludee;
+    proxy->occluder_mesh = (c->occluder && !proxy->transparent) ? coarsest : nullptr;
+    proxy->uniforms = &c->material->uniforms_;
+    if (shared_material->uniforms_enabled())
+    {
+      proxy->uniforms_size = sizeof(c->material->uniforms_);
+      proxy->uniforms_block = shared_material->uniforms_name_;
+    }
+    else
+    {
+      proxy->uniforms_size = 0;
+      proxy->uniforms_block = nullptr;
+    }
+
+    // The shared material holds the textures of the instance just set up, common textures come first.
+    proxy->num_textures = glm::min((uint32)shared_material->gpu_.tex.size(), (uint32)kMaxTextureUnits);
+    for (uint32 i = 0; i < proxy->num_textures; ++i)
+    {
+      proxy->textures[i] = shared_material->gpu_.tex[i];
+      proxy->texture_sources[i] = (i >= shared_material->common_textures_) ? c->material->texture(i).get() : nullptr;
+    }
+    proxy->texture_set = TextureSetHash(proxy->textures, proxy->num_textures);
+
+    proxy->world = c->transform()->render_matrix();
+    proxy->world_version = c->transform()->render_version_counter();
+    proxy->bounds_version = *proxy->world_version;
+    proxy->bounds.transform(*proxy->world, &proxy->center, &proxy->extents);
+    proxy->valid = true;
     return true;
   }
 
-  void System::Renderer::render(ref_ptr<vxr::Renderer> c, DisplayList* frame)
+  void System::Renderer::capture(Proxy* p, const vec3& eye, Draw* draw)
   {
-    VXR_TRACE_SCOPE("VXR", "Render");
+    Proxy& proxy = *p;
+    draw->model = *proxy.world;
+    vec3 d = vec3(draw->model[3]) - eye;
+    draw->depth = glm::dot(d, d);
 
-    ref_ptr<mat::Material> shared_material = c->material->sharedMaterial();
-    ref_ptr<Mesh> mesh = c->getComponent<vxr::MeshFilter>()->mesh;
-    if (shared_material->uniforms_enabled())
+    if (proxy.num_lods > 1 && lod_scale_ > 0.0f)
+    {
+      // Fraction of the screen height covered by the bounding sphere.
+      vec4 center = draw->model * vec4(proxy.bounds.center, 1.0f);
+      float scale = glm::sqrt(glm::max(glm::dot(vec3(draw->model[0]), vec3(draw->model[0])),
+        glm::max(glm::dot(vec3(draw->model[1]), vec3(draw->model[1])), glm::dot(vec3(draw->model[2]), vec3(draw->model[2])))));
+      float w = glm::max(glm::dot(lod_clip_w_, center), 1e-4f);
+      float screen_size = proxy.bounds.radius * scale * lod_scale_ / w;
+
+      uint32 lod = proxy.lod;
+      while (lod + 1 < proxy.num_lods && screen_size < proxy.lods[lod + 1].screen_size * (1.0f - kLODHysteresis))
+      {
+        lod++;
+      }
+      while (lod > 0 && screen_size > proxy.lods[lod].screen_size * (1.0f + kLODHysteresis))
+      {
+        lod--;
+      }
+      proxy.lod = lod;
+    }
+
+    const Proxy::Geometry& geometry = proxy.lods[(lod_scale_ > 0.0f) ? proxy.lod : 0];
+    draw->material = proxy.material;
+    draw->instanced_material = proxy.instanced_material;
+    draw->equal_material = proxy.equal_material;
+    draw->equal_instanced_material = proxy.equal_instanced_material;
+    draw->cull = proxy.cull;
+    draw->vertex_buffer = geometry.vertex_buffer;
+    draw->index_buffer = geometry.index_buffer;
+    draw->index_count = geometry.index_count;
+    draw->index_offset = geometry.index_offset;
+    draw->base_vertex = geometry.base_vertex;
+    draw->index_format = geometry.index_format;
+    draw->transparent = proxy.transparent;
+    draw->instances = 1;
+    draw->instances_offset = 0;
+    draw->uniforms = proxy.uniforms;
+    draw->uniforms_offset = 0;
+    draw->uniforms_size = proxy.uniforms_size;
+    draw->uniforms_block = proxy.uniforms_block;
+    draw->num_textures = proxy.num_textures;
+    for (uint32 i = 0; i < proxy.num_textures; ++i)
+    {
+      draw->textures[i] = proxy.textures[i];
+    }
+    draw->texture_set = proxy.texture_set;
+  }
+
+  void System::Renderer::queue(uint32 index, RenderBucket* bucket)
+  {
+    Draw& draw = draws_[index];
+    if (draw.uniforms_size && draw.instances == 1)
+    {
+      draw.uniforms_offset = packUniforms(draw.uniforms, draw.uniforms_size);
+    }
+
+    uint32 program = RenderContext::index(draw.material.id);
+    if (draw.transparent)
+    {
+      bucket->add(RenderBucket::TransparentKey(0, 0, program, draw.texture_set, draw.depth), index);
+    }
+    else if (front_to_back_)
+    {
+      bucket->add(RenderBucket::FrontToBackKey(0, 0, program, draw.texture_set, draw.depth), index);
+    }
+    else
+    {
+      bucket->add(RenderBucket::OpaqueKey(0, 0, program, draw.texture_set, draw.depth), index);
+    }
+
+    if (depth_prepass_ && !draw.transparent && draw.equal_material.id)
     {
-      VXR_TRACE_BEGIN("VXR", "Fill Uniform Buffer");
-      frame->fillBufferCommand()
-        .set_buffer(shared_material->uniformBuffer())
-        .set_data(&c->material->uniforms_)
-        .set_size(sizeof(c->material->uniforms_));
-      VXR_TRACE_END("VXR", "Fill Uniform Buffer");
+      prepassMaterial(draw.cull, draw.instances > 1);
+      prepass_.add(RenderBucket::FrontToBackKey(0, 0, draw.cull, 0, draw.depth), index);
     }
+  }
+
+  uint64 System::Renderer::BatchKey(const Draw& draw)
+  {
+    uint64 hash = 14695981039346656037ull;
+    const uint32 words[] = { draw.instanced_material.id, draw.vertex_buffer.id, draw.index_buffer.id, draw.index_count, draw.index_offset, draw.base_vertex, draw.texture_set };
+    for (uint32 word : words)
+    {
+      hash = (hash ^ word) * 1099511628211ull;
+    }
+    return hash;
+  }
+
+  bool System::Renderer::SameBatch(const Draw& a, const Draw& b)
+  {
+    if (a.instanced_material.id != b.instanced_material.id || a.vertex_buffer.id != b.vertex_buffer.id ||
+        a.index_buffer.id != b.index_buffer.id || a.index_count != b.index_count || a.index_offset != b.index_offset ||
+        a.base_vertex != b.base_vertex || a.index_format != b.index_format || a.num_textures != b.num_textures)
+    {
+      return false;
+    }
+    for (uint32 i = 0; i < a.num_textures && i < kMaxTextureUnits; ++i)
+    {
+      if (a.textures[i].id != b.textures[i].id)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void System::Renderer::batch()
+  {
+    VXR_TRACE_SCOPE("VXR", "Batch Instances");
+    // Sorting by key (then by draw index) leaves the draws of each batch next to each other.
+    std::sort(batches_.begin(), batches_.end());
+
+    uint32 begin = 0;
+    while (begin < batches_.size())
+    {
+      const Draw& first = draws_[batches_[begin].second];
+      uint32 end = begin + 1;
+      while (end < batches_.size() && batches_[end].first == batches_[begin].first && SameBatch(first, draws_[batches_[end].second]))
+      {
+        end++;
+      }
+
+      for (uint32 i = begin; i < end; i += kMaxInstancesPerDraw)
+      {
+        uint32 count = glm::min((uint32)kMaxInstancesPerDraw, end - i);
+        if (count == 1)
+        {
+          queue(batches_[i].second, &opaque_);
+        }
+        else
+        {
+          Draw instanced = draws_[batches_[i].second];
+          instanced.material = instanced.instanced_material;
+          instanced.equal_material = instanced.equal_instanced_material;
+          instanced.instances = count;
+          instanced.instances_offset = packInstances(&batches_[i], count);
+          for (uint32 j = 1; j < count; ++j)
+          {
+            instanced.depth = glm::min(instanced.depth, draws_[batches_[i + j].second].depth);
+          }
+
+          uint32 index = (uint32)draws_.size();
+          draws_.push_back(instanced);
+          queue(index, &opaque_);
+        }
+      }
+      begin = end;
+    }
+  }
+
+  void System::Renderer::render(const Draw& draw, bool depth_only, DisplayList* frame)
+  {
+    VXR_TRACE_SCOPE("VXR", "Render");
+
     VXR_TRACE_BEGIN("VXR", "Setup Material");
-    frame->setupMaterialCommand()
-      .set_material(shared_material->material())
-      .set_buffer(0, mesh->vertexBuffer())
-      .set_v_texture(shared_material->textureInput())
-      .set_uniform_buffer(0, Engine::ref().camera()->common_uniforms_buffer())
-      .set_uniform_buffer(1, Engine::ref().light()->light_uniforms_buffer())
-      .set_uniform_buffer(2, ((shared_material->uniforms_enabled()) ? shared_material->uniformBuffer() : gpu::Buffer{}))
-      .set_model_matrix(c->transform()->world_transform());
+    if (depth_only)
+    {
+      // Only the position of the vertices and the model matrices are read.
+      DisplayList::SetupMaterialData& material = frame->setupMaterialCommand()
+        .set_material(prepass_materials_[draw.cull][draw.instances > 1])
+        .set_buffer(0, draw.vertex_buffer)
+        .set_uniform_buffer(0, common_uniforms_buffer_)
+        .set_model_matrix(draw.model);
+      if (draw.instances > 1)
+      {
+        material
+          .set_uniform_buffer(2, draw_uniforms_buffer_)
+          .set_uniform_buffer_offset(2, draw.instances_offset)
+          .set_uniform_buffer_size(2, draw.instances * sizeof(Shader::InstanceData))
+          .set_uniform_block(2, "Instances");
+      }
+    }
+    else
+    {
+      // Draws whose depth was laid down by the pre-pass shade only the pixels matching it.
+      const bool equal = depth_prepass_ && !draw.transparent && draw.equal_material.id;
+      DisplayList::SetupMaterialData& material = frame->setupMaterialCommand()
+        .set_material(equal ? draw.equal_material : draw.material)
+        .set_buffer(0, draw.vertex_buffer)
+        .set_uniform_buffer(0, common_uniforms_buffer_)
+        .set_uniform_buffer(1, light_uniforms_buffer_)
+        .set_uniform_buffer(3, light_clusters_buffer_)
+        .set_uniform_buffer(4, light_indices_buffer_)
+        .set_model_matrix(draw.model);
+      if (draw.instances > 1)
+      {
+        // Model matrices and material uniforms are read per instance from the Instances block.
+        material
+          .set_uniform_buffer(2, draw_uniforms_buffer_)
+          .set_uniform_buffer_offset(2, draw.instances_offset)
+          .set_uniform_buffer_size(2, draw.instances * sizeof(Shader::InstanceData))
+          .set_uniform_block(2, "Instances");
+      }
+      else if (draw.uniforms_size)
+      {
+        material
+          .set_uniform_buffer(2, draw_uniforms_buffer_)
+          .set_uniform_buffer_offset(2, draw.uniforms_offset)
+          .set_uniform_buffer_size(2, draw.uniforms_size)
+          .set_uniform_block(2, draw.uniforms_block);
+      }
+      for (uint32 i = 0; i < draw.num_textures && i < kMaxTextureUnits; ++i)
+      {
+        material.set_texture(i, draw.textures[i]);
+      }
+    }
     VXR_TRACE_END("VXR", "Setup Material");
     VXR_TRACE_BEGIN("VXR", "Render");
     frame->renderCommand()
-      .set_index_buffer(mesh->indexBuffer())
-      .set_count(mesh->indexCount())
-      .set_type(mesh->indexFormat());
-    ///TODO: Missing instancing.
+      .set_index_buffer(draw.index_buffer)
+      .set_count(draw.index_count)
+      .set_offset(draw.index_offset)
+      .set_base_vertex(draw.base_vertex)
+      .set_type(draw.index_format)
+      .set_instances(draw.instances);
     VXR_TRACE_END("VXR", "Render");
   }
 
+  void System::Renderer::submit(const RenderBucket& bucket, bool depth_only)
+  {
+    VXR_TRACE_SCOPE("VXR", "Submit");
+    const uint32 num_draws = bucket.size();
+    if (num_draws == 0)
+    {
+      return;
+    }
+
+    // Draws are recorded in contiguous slices of the sorted bucket, one display list per slice.
+    const uint32 num_chunks = (num_draws + kDrawsPerChunk - 1) / kDrawsPerChunk;
+    Engine::ref().submitParallelDisplayLists(num_chunks, [this, &bucket, num_draws, depth_only](uint32 chunk, DisplayList& frame)
+    {
+      const uint32 begin = chunk * kDrawsPerChunk;
+      const uint32 end = glm::min(begin + kDrawsPerChunk, num_draws);
+      for (uint32 i = begin; i < end; ++i)
+      {
+        // Send render commands.
+        render(draws_[bucket.index(i)], depth_only, &frame);
+      }
+    });
+  }
+
+  gpu::Material System::Renderer::prepassMaterial(Cull::Enum cull, bool instanced)
+  {
+    gpu::Material& material = prepass_materials_[cull][instanced];
+    if (!material.id)
+    {
+      gpu::Material::Info info;
+      info.shader.vert = Shader::Load("depth_prepass.vert");
+      info.shader.frag = Shader::Load("depth_prepass.frag");
+      // Positions are read straight from the interleaved mesh vertices.
+#if VXR_MESH_PRECOMPUTE_TANGENTS
+      info.attribs[0] = { "attr_position", VertexFormat::Float3, 0, VertexStep::PerVertex, sizeof(vec4), sizeof(vec4) + sizeof(vec3) * 2 + sizeof(vec2) };
+#else
+      info.attribs[0] = { "attr_position", VertexFormat::Float3, 0, VertexStep::PerVertex, 0, sizeof(vec3) * 2 + sizeof(vec2) };
+#endif
+      info.cull = cull;
+      info.rgba_write = false;
+      if (instanced)
+      {
+        Shader::Instanced(info.shader.vert, info.shader.frag, nullptr, &info.shader.vert, &info.shader.frag);
+        info.instanced = true;
+      }
+      material = Engine::ref().gpu()->createMaterial(info);
+    }
+    return material;
+  }
+
+  uint32 System::Renderer::reserveUniforms(uint32 size)
+  {
+    uint32 offset = (uint32)draw_uniforms_->size();
+    draw_uniforms_->resize(offset + ((size + kUniformBufferAlignment - 1) & ~(kUniformBufferAlignment - 1)));
+    return offset;
+  }
+
+  uint32 System::Renderer::packUniforms(const void* uniforms, uint32 size)
+  {
+    // Renderers sharing a material instance share its uniforms too.
+    auto it = draw_uniforms_offsets_.find(uniforms);
+    if (it != draw_uniforms_offsets_.end())
+    {
+      return it->second;
+    }
+
+    uint32 offset = reserveUniforms(size);
+    memcpy(&(*draw_uniforms_)[offset], uniforms, size);
+    draw_uniforms_offsets_[uniforms] = offset;
+    return offset;
+  }
+
+  uint32 System::Renderer::packInstances(const std::pair<uint64, uint32>* batch, uint32 count)
+  {
+    uint32 offset = reserveUniforms(count * sizeof(Shader::InstanceData));
+    for (uint32 i = 0; i < count; ++i)
+    {
+      const Draw& draw = draws_[batch[i].second];
+      uint8* instance = &(*draw_uniforms_)[offset + i * sizeof(Shader::InstanceData)];
+      memcpy(instance + offsetof(Shader::InstanceData, model), &draw.model, sizeof(mat4));
+      if (draw.uniforms_size)
+      {
+        memcpy(instance + offsetof(Shader::InstanceData, uniforms), draw.uniforms, draw.uniforms_size);
+      }
+    }
+    return offset;
+  }
+
+  void System::Renderer::uploadUniforms()
+  {
+    VXR_TRACE_SCOPE("VXR", "Upload Uniforms");
+    if (draw_uniforms_->empty())
+    {
+      return;
+    }
+
+    // Grown in steps, so that the buffer is not reallocated every time the number of instances changes.
+    static const uint32 kGrowSize = 4 * kUniformBufferAlignment;
+    draw_uniforms_->resize((draw_uniforms_->size() + kGrowSize - 1) / kGrowSize * kGrowSize);
+
+    if (draw_uniforms_buffer_.id == 0)
+    {
+      draw_uniforms_buffer_ = Engine::ref().gpu()->createBuffer({ BufferType::Uniform, (uint32)draw_uniforms_->size(), Usage::Stream, "Draw Uniforms" });
+    }
+
+    // Read in place by the render thread, the GPU keeps the data alive until the frame has been executed.
+    DisplayList frame;
+    frame.fillBufferCommand()
+      .set_buffer(draw_uniforms_buffer_)
+      .set_data(draw_uniforms_->data())
+      .set_size((uint32)draw_uniforms_->size())
+      .set_persistent(true);
+    Engine::ref().submitDisplayList(std::move(frame));
+    Engine::ref().gpu()->releaseData(draw_uniforms_);
+  }
+
   bool System::Renderer::setupSkybox()
   {
     VXR_TRACE_SCOPE("VXR", "Setup Skybox");
@@ -247,17 +924,31 @@ namespace vxr
       .set_data(&skybox->material->uniforms_)
       .set_size(sizeof(skybox->material->uniforms_));
     VXR_TRACE_END("VXR", "Fill Uniform Buffer");
-    frame.setupMaterialCommand()
+    DisplayList::SetupMaterialData material;
+    material
       .set_material(shared_material->material())
       .set_buffer(0, cube->vertexBuffer())
       .set_v_texture(shared_material->textureInput())
       .set_uniform_buffer(0, Engine::ref().camera()->common_uniforms_buffer())
       .set_uniform_buffer(1, shared_material->uniformBuffer())
       .set_model_matrix(skybox->transform()->world_transform());
-    frame.renderCommand()
+    DisplayList::RenderData render;
+    render
       .set_index_buffer(cube->indexBuffer())
       .set_count(cube->indexCount())
+      .set_offset(cube->indexOffset())
+      .set_base_vertex(cube->baseVertex())
       .set_type(cube->indexFormat());
+    // The skybox draw only changes along with its resources or transform, so it is recorded once.
+    uint64 key = RetainedDisplayList::Key(material, render);
+    if (!skybox_commands_.valid() || skybox_commands_.key() != key)
+    {
+      DisplayList& commands = skybox_commands_.record(key);
+      commands.setupMaterialCommand() = material;
+      commands.renderCommand() = render;
+      skybox_commands_.finish();
+    }
+    frame.retainedCommand(skybox_commands_);
     VXR_TRACE_END("VXR", "Skybox");
     Engine::ref().submitDisplayList(std::move(frame));
   }
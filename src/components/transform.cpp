@@ -27,6 +27,9 @@
 #include "../../include/engine/engine.h"
 #include "../../include/core/gameobject.h"
 #include "../../include/core/scene.h"
+#include "../../include/utils/math.h"
+
+#include <algorithm>
 
 namespace vxr 
 {
@@ -34,19 +37,10 @@ namespace vxr
   Transform::Transform()
   {
     set_name("Transform");
-    dirty_ = true;
+    system_ = Engine::ref().transform().get();
+    id_ = system_->allocate();
     parent_ = nullptr;
 
-    position_ = vec3(0.0f);
-    rotation_ = quat(1.0f, 0.0f, 0.0f, 0.0f);
-    scale_ = vec3(1.0f);
-
-    world_position_ = vec3(0.0f);
-    world_rotation_ = quat(1.0f, 0.0f, 0.0f, 0.0f);
-    world_scale_ = vec3(1.0f);
-
-    world_transform_ = mat4(1.0f);
-
     euler_angles_ = vec3(0.0f);
   }
 
@@ -57,43 +51,45 @@ namespace vxr
 
   void Transform::onGUI()
   {
+    vec3 position = local_position();
+    vec3 scale = local_scale();
     ImGui::Spacing();
     ImGui::Text("Position"); ImGui::SameLine();
-    if (ImGui::DragFloat3(uiText("##P").c_str(), (float*)&position_, 0.01f, -FLT_MAX, FLT_MAX)) set_local_position(position_);
+    if (ImGui::DragFloat3(uiText("##P").c_str(), (float*)&position, 0.01f, -FLT_MAX, FLT_MAX)) set_local_position(position);
     /// TODO: Fix the euler angles display and rotation from UI for all cases.
     ImGui::Text("Rotation"); ImGui::SameLine();
     if (ImGui::DragFloat3(uiText("##R").c_str(), (float*)&euler_angles_, 1.0f, -FLT_MAX, FLT_MAX)) set_local_rotation(euler_angles_); else euler_angles_ = local_rotation_angles();
     ImGui::Text("Scale   "); ImGui::SameLine();
-    if (ImGui::DragFloat3(uiText("##S").c_str(), (float*)&scale_, 0.01f, -FLT_MAX, FLT_MAX)) set_local_scale(scale_);
+    if (ImGui::DragFloat3(uiText("##S").c_str(), (float*)&scale, 0.01f, -FLT_MAX, FLT_MAX)) set_local_scale(scale);
   }
 
   void Transform::set_local_position(const vec3& position)
   {
-    position_ = position;
+    system_->position_[id_] = position;
     markForUpdate();
   }
 
   void Transform::set_local_position_x(const float& v)
   {
-    position_.x = v;
+    system_->position_[id_].x = v;
     markForUpdate();
   }
 
   void Transform::set_local_position_y(const float& v)
   {
-    position_.y = v;
+    system_->position_[id_].y = v;
     markForUpdate();
   }
 
   void Transform::set_local_position_z(const float& v)
   {
-    position_.z = v;
+    system_->position_[id_].z = v;
     markForUpdate();
   }
 
   void Transform::set_local_rotation(const quat& rotation)
   {
-    rotation_ = rotation;
+    system_->rotation_[id_] = rotation;
     markForUpdate();
   }
 
@@ -114,29 +110,30 @@ namespace vxr
 
   void Transform::set_local_scale(const vec3& scale)
   {
-    scale_ = scale;
+    vec3& local_scale = system_->scale_[id_];
+    local_scale = scale;
     markForUpdate();
 
-    if (scale_.x == 0.0f)
+    if (local_scale.x == 0.0f)
     {
-      scale_.x = glm::epsilon<float>();
+      local_scale.x = glm::epsilon<float>();
     }
-    if (scale_.y == 0.0f)
+    if (local_scale.y == 0.0f)
     {
-      scale_.y = glm::epsilon<float>();
+      local_scale.y = glm::epsilon<float>();
     }
-    if (scale_.z == 0.0f)
+    if (local_scale.z == 0.0f)
     {
-      scale_.z = glm::epsilon<float>();
+      local_scale.z = glm::epsilon<float>();
     }
   }
 
 
   void Transform::set_transform(const vec3& position, const quat& rotation, const vec3& scale)
   {
-    position_ = position;
-    rotation_ = rotation;
-    scale_ = scale;
+    system_->position_[id_] = position;
+    system_->rotation_[id_] = rotation;
+    system_->scale_[id_] = scale;
     markForUpdate();
   }
 
@@ -147,8 +144,8 @@ namespace vxr
 
   void Transform::set_transform(const vec3& position, const quat& rotation)
   {
-    position_ = position;
-    rotation_ = rotation;
+    system_->position_[id_] = position;
+    system_->rotation_[id_] = rotation;
     markForUpdate();
   }
 
@@ -245,22 +242,23 @@ namespace vxr
 
   void Transform::translate(const vec3& delta, TransformSpace::Enum space)
   {
+    vec3& position = system_->position_[id_];
     switch (space)
     {
     case TransformSpace::Local:
-      position_ += rotation_ * delta;
+      position += local_rotation() * delta;
       break;
     case TransformSpace::Parent:
-      position_ += delta;
+      position += delta;
       break;
     case TransformSpace::World:
       if (!parent_)
       {
-        position_ += delta;
+        position += delta;
       }
       else
       {
-        position_ += vec3(glm::inverse(parent_->world_transform()) * vec4(delta, 0.0f));
+        position += vec3(glm::inverse(parent_->world_transform()) * vec4(delta, 0.0f));
       }
       break;
     }
@@ -284,23 +282,24 @@ namespace vxr
 
   void Transform::rotate(const quat& delta, TransformSpace::Enum space)
   {
+    quat& rotation = system_->rotation_[id_];
     switch (space)
     {
     case TransformSpace::Local:
-      rotation_ = glm::normalize(rotation_ * delta);
+      rotation = glm::normalize(rotation * delta);
       break;
     case TransformSpace::Parent:
-      rotation_ = glm::normalize(delta * rotation_);
+      rotation = glm::normalize(delta * rotation);
       break;
     case TransformSpace::World:
       if (!parent_)
       {
-        rotation_ = glm::normalize(delta * rotation_);
+        rotation = glm::normalize(delta * rotation);
       }
       else
       {
         quat world_rotation = parent_->world_rotation();
-        rotation_ *= glm::inverse(world_rotation) * delta * world_rotation;
+        rotation *= glm::inverse(world_rotation) * delta * world_rotation;
       }
       break;
     }
@@ -329,37 +328,39 @@ namespace vxr
 
   void Transform::rotateAround(const vec3& point, const quat& delta, TransformSpace::Enum space)
   {
+    vec3& position = system_->position_[id_];
+    quat& rotation = system_->rotation_[id_];
     vec3 parent_space_point;
-    quat prev_rotation = rotation_;
+    quat prev_rotation = rotation;
     switch (space)
     {
     case TransformSpace::Local:
       parent_space_point = local_transform() * vec4(point, 0.0f);
-      rotation_ = glm::normalize(rotation_ * delta);
+      rotation = glm::normalize(rotation * delta);
       break;
 
     case TransformSpace::Parent:
       parent_space_point = point;
-      rotation_ = glm::normalize(delta * rotation_);
+      rotation = glm::normalize(delta * rotation);
       break;
 
     case TransformSpace::World:
       if (!parent_)
       {
         parent_space_point = point;
-        rotation_ = glm::normalize(delta * rotation_);
+        rotation = glm::normalize(delta * rotation);
       }
       else
       {
         parent_space_point = glm::inverse(parent_->world_transform()) * vec4(point, 0.0f);
         quat world_rotation = parent_->world_rotation();
-        rotation_ = rotation_ * glm::inverse(world_rotation) * delta * world_rotation;
+        rotation = rotation * glm::inverse(world_rotation) * delta * world_rotation;
       }
       break;
     }
 
-    vec3 prev_relative_position = glm::inverse(prev_rotation) * (position_ - parent_space_point);
-    position_ = rotation_ * prev_relative_position + parent_space_point;
+    vec3 prev_relative_position = glm::inverse(prev_rotation) * (position - parent_space_point);
+    position = rotation * prev_relative_position + parent_space_point;
 
     markForUpdate();
   }
@@ -413,42 +414,42 @@ namespace vxr
 
   const vec3& Transform::local_position() const
   {
-    return position_;
+    return system_->position_[id_];
   }
 
   const quat& Transform::local_rotation() const
   {
-    return rotation_;
+    return system_->rotation_[id_];
   }
 
   vec3 Transform::local_rotation_angles() const
   {
-    return glm::degrees(glm::eulerAngles((rotation_)));
+    return glm::degrees(glm::eulerAngles((local_rotation())));
   }
 
   const vec3& Transform::local_scale() const
   {
-    return scale_;
+    return system_->scale_[id_];
   }
 
   vec3 Transform::local_forward() const
   {
-    return rotation_ * kWorldForward;
+    return local_rotation() * kWorldForward;
   }
 
   vec3 Transform::local_right() const
   {
-    return rotation_ * kWorldRight;
+    return local_rotation() * kWorldRight;
   }
 
   vec3 Transform::local_up() const
   {
-    return rotation_ * kWorldUp;
+    return local_rotation() * kWorldUp;
   }
 
   mat4 Transform::local_transform() const
   {
-    return glm::translate(position_) * glm::scale(scale_) * glm::toMat4(rotation_);
+    return glm::translate(local_position()) * glm::scale(local_scale()) * glm::toMat4(local_rotation());
   }
 
   const vec3& Transform::world_position() const
@@ -458,7 +459,7 @@ namespace vxr
       updateWorldTransform();
     }
 
-    return world_position_;
+    return system_->world_position_[id_];
   }
 
   const quat& Transform::world_rotation() const
@@ -468,7 +469,7 @@ namespace vxr
       updateWorldTransform();
     }
 
-    return world_rotation_;
+    return system_->world_rotation_[id_];
   }
 
   vec3 Transform::world_rotation_angles() const
@@ -484,7 +485,7 @@ namespace vxr
       updateWorldTransform();
     }
 
-    return world_scale_;
+    return system_->world_scale_[id_];
   }
 
   vec3 Transform::world_forward() const
@@ -494,7 +495,7 @@ namespace vxr
       updateWorldTransform();
     }
 
-    return world_rotation_ * kWorldForward;
+    return system_->world_rotation_[id_] * kWorldForward;
   }
 
   vec3 Transform::world_right() const
@@ -504,7 +505,7 @@ namespace vxr
       updateWorldTransform();
     }
 
-    return world_rotation_ * kWorldRight;
+    return system_->world_rotation_[id_] * kWorldRight;
   }
 
   vec3 Transform::world_up() const
@@ -514,7 +515,7 @@ namespace vxr
       updateWorldTransform();
     }
 
-    return world_rotation_ * kWorldUp;
+    return system_->world_rotation_[id_] * kWorldUp;
   }
 
   mat4 Transform::world_transform() const
@@ -524,7 +525,37 @@ namespace vxr
       updateWorldTransform();
     }
 
-    return world_transform_;
+    return system_->world_[id_];
+  }
+
+  const mat4* Transform::world_matrix() const
+  {
+    return &system_->world_[id_];
+  }
+
+  uint32 Transform::version() const
+  {
+    return system_->version_[id_];
+  }
+
+  const uint32* Transform::version_counter() const
+  {
+    return &system_->version_[id_];
+  }
+
+  const mat4* Transform::render_matrix() const
+  {
+    return &system_->render_world_[id_];
+  }
+
+  uint32 Transform::render_version() const
+  {
+    return system_->render_version_[id_];
+  }
+
+  const uint32* Transform::render_version_counter() const
+  {
+    return &system_->render_version_[id_];
   }
 
   void Transform::set_parent(ref_ptr<Transform> parent)
@@ -542,8 +573,14 @@ namespace vxr
       quat rotation;
       glm::decompose(prev_world_transform, scale, rotation, position, skew, perspective);
 
+      if (parent_.get())
+      {
+        std::vector<ref_ptr<Transform>>& siblings = parent_->children_;
+        siblings.erase(std::remove(siblings.begin(), siblings.end(), ref_ptr<Transform>(this)), siblings.end());
+      }
       parent_ = parent;
       parent_->children_.push_back(this);
+      system_->set_parent(id_, parent->id_);
 
       set_transform(position, rotation, scale);
 
@@ -577,81 +614,454 @@ namespace vxr
 
   void Transform::updateWorldTransform() const
   {
-    VXR_TRACE_SCOPE("VXR", "Compute Transformations");
+    system_->update(id_);
+  }
 
-    mat4 transform = local_transform();
+  void Transform::markForUpdate() const
+  {
+    system_->markForUpdate(id_);
+  }
 
-    if (!parent_)
+  bool Transform::hasChanged() const
+  {
+    return system_->dirty_[id_] != 0;
+  }
+
+  System::Transform::Transform()
+  {
+  }
+
+  System::Transform::~Transform()
+  {
+  }
+
+  static const uint32 kTransformsPerChunk = 1024;
+  static const uint32 kTransformsPerBatch = 64;
+  static const mat4 kIdentity = mat4(1.0f);
+  static const uint8 kStepListed = 1;
+  static const uint8 kRenderListed = 2;
+
+  static void List(uint32 id, uint8 flag, paged_array<uint8>* listed, std::vector<uint32>* slots)
+  {
+    if (!((*listed)[id] & flag))
     {
-      world_transform_ = transform;
-      world_position_ = position_;
-      world_rotation_ = rotation_;
-      world_scale_ = scale_;
+      (*listed)[id] |= flag;
+      slots->push_back(id);
     }
-    else
+  }
+
+  void System::Transform::renderUpdate()
+  {
+    VXR_TRACE_SCOPE("VXR", "Transform Render Update");
+    updateLevels(true);
+  }
+
+  void System::Transform::set_interpolation(bool enabled)
+  {
+    if (enabled && !interpolation_)
     {
-      world_transform_ = parent_->world_transform() * transform;
-      world_position_ = world_transform_[3];
-      world_rotation_ = parent_->world_rotation() * rotation_;
-      world_scale_ = parent_->world_scale() * scale_;
+      // Nothing was kept while disabled, every slot is kept by the next snapshot.
+      for (uint32 id = 0; id < num_slots_; ++id)
+      {
+        snapshot_version_[id] = kNone;
+        List(id, kStepListed, &listed_, &step_slots_);
+      }
+    }
+    else if (!enabled && interpolation_)
+    {
+      // Interpolated render matrices are replaced by the world ones.
+      for (uint32 id : step_slots_)
+      {
+        listed_[id] &= ~kStepListed;
+        List(id, kRenderListed, &listed_, &render_slots_);
+      }
+      step_slots_.clear();
     }
+    interpolation_ = enabled;
+  }
 
-    dirty_ = false;
+  bool System::Transform::interpolation() const
+  {
+    return interpolation_;
   }
 
-  void Transform::markForUpdate() const
+  void System::Transform::snapshot()
   {
-    if (dirty_)
+    if (!interpolation_)
     {
       return;
     }
 
-    dirty_ = true;
-    for (uint32 i = 0; i < children_.size(); ++i)
+    VXR_TRACE_SCOPE("VXR", "Transform Snapshot");
+    // Only the slots updated since the last snapshot have different local transformations. They are drawn
+    // with their world matrix until updated again.
+    updateLevels(false);
+    for (uint32 id : step_slots_)
     {
-      children_[i]->markForUpdate();
+      previous_position_[id] = position_[id];
+      previous_rotation_[id] = rotation_[id];
+      previous_scale_[id] = scale_[id];
+      snapshot_version_[id] = version_[id];
+      listed_[id] &= ~kStepListed;
+      List(id, kRenderListed, &listed_, &render_slots_);
     }
+    step_slots_.clear();
   }
 
-  bool Transform::hasChanged() const
+  void System::Transform::set_step_fraction(float fraction)
   {
-    return dirty_;
+    step_fraction_ = glm::clamp(fraction, 0.0f, 1.0f);
   }
 
-  System::Transform::Transform()
+  void System::Transform::updateLevels(bool render)
   {
+    // Every changed slot of a level reads the world transformations of its parent, updated with the previous level.
+    for (uint32 depth = 0; depth < dirty_levels_.size(); ++depth)
+    {
+      std::vector<uint32>& level = dirty_levels_[depth];
+      if (level.empty())
+      {
+        continue;
+      }
+
+      // Stale entries are dropped, and slots listed twice queued once.
+      uint32 count = 0;
+      for (uint32 id : level)
+      {
+        if (dirty_[id] == 1 && depth_[id] == depth)
+        {
+          dirty_[id] = 2;
+          level[count++] = id;
+          record(id);
+        }
+      }
+      level.resize(count);
+
+      const uint32 num_chunks = (count + kTransformsPerChunk - 1) / kTransformsPerChunk;
+      Engine::ref().runParallel(num_chunks, [this, &level](uint32 chunk)
+      {
+        const uint32 begin = chunk * kTransformsPerChunk;
+        const uint32 end = glm::min(begin + kTransformsPerChunk, (uint32)level.size());
+        for (uint32 i = begin; i < end; i += kTransformsPerBatch)
+        {
+          compute(&level[i], glm::min(kTransformsPerBatch, end - i));
+        }
+      });
+      level.clear();
+    }
+
+    if (!render)
+    {
+      return;
+    }
+
+    // Slots to refresh are sorted by depth, as interpolated ones read the render matrix of their parent.
+    render_levels_.resize(dirty_levels_.size());
+    for (uint32 id : step_slots_)
+    {
+      render_levels_[depth_[id]].push_back(id);
+    }
+    for (uint32 id : render_slots_)
+    {
+      listed_[id] &= ~kRenderListed;
+      if (!(listed_[id] & kStepListed))
+      {
+        render_levels_[depth_[id]].push_back(id);
+      }
+    }
+    render_slots_.clear();
+
+    for (std::vector<uint32>& level : render_levels_)
+    {
+      if (level.empty())
+      {
+        continue;
+      }
+
+      const uint32 num_chunks = ((uint32)level.size() + kTransformsPerChunk - 1) / kTransformsPerChunk;
+      Engine::ref().runParallel(num_chunks, [this, &level](uint32 chunk)
+      {
+        const uint32 begin = chunk * kTransformsPerChunk;
+        const uint32 end = glm::min(begin + kTransformsPerChunk, (uint32)level.size());
+        uint32 batch[kTransformsPerBatch];
+        uint32 count = 0;
+        // Slots updated since the last snapshot are interpolated, the rest draw their world matrix.
+        for (uint32 i = begin; i < end; ++i)
+        {
+          const uint32 id = level[i];
+          if (interpolation_ && snapshot_version_[id] != version_[id])
+          {
+            batch[count++] = id;
+            if (count == kTransformsPerBatch)
+            {
+              interpolate(batch, count);
+              count = 0;
+            }
+          }
+          else if (render_source_[id] != version_[id])
+          {
+            render_world_[id] = world_[id];
+            render_source_[id] = version_[id];
+            render_version_[id]++;
+          }
+        }
+        interpolate(batch, count);
+      });
+      level.clear();
+    }
   }
 
-  System::Transform::~Transform()
+  uint32 System::Transform::allocate()
   {
+    const uint32 id = num_slots_++;
+    if (id >= position_.size())
+    {
+      position_.grow(num_slots_);
+      rotation_.grow(num_slots_);
+      scale_.grow(num_slots_);
+      world_.grow(num_slots_);
+      world_position_.grow(num_slots_);
+      world_rotation_.grow(num_slots_);
+      world_scale_.grow(num_slots_);
+      parent_.grow(num_slots_);
+      first_child_.grow(num_slots_);
+      next_sibling_.grow(num_slots_);
+      depth_.grow(num_slots_);
+      dirty_.grow(num_slots_);
+      version_.grow(num_slots_);
+      previous_position_.grow(num_slots_);
+      previous_rotation_.grow(num_slots_);
+      previous_scale_.grow(num_slots_);
+      snapshot_version_.grow(num_slots_);
+      render_world_.grow(num_slots_);
+      render_source_.grow(num_slots_);
+      render_version_.grow(num_slots_);
+      listed_.grow(num_slots_);
+    }
+
+    position_[id] = vec3(0.0f);
+    rotation_[id] = quat(1.0f, 0.0f, 0.0f, 0.0f);
+    scale_[id] = vec3(1.0f);
+    world_[id] = mat4(1.0f);
+    world_position_[id] = vec3(0.0f);
+    world_rotation_[id] = quat(1.0f, 0.0f, 0.0f, 0.0f);
+    world_scale_[id] = vec3(1.0f);
+    parent_[id] = kNone;
+    first_child_[id] = kNone;
+    next_sibling_[id] = kNone;
+    dirty_[id] = 1;
+    version_[id] = 0;
+    previous_position_[id] = position_[id];
+    previous_rotation_[id] = rotation_[id];
+    previous_scale_[id] = scale_[id];
+    snapshot_version_[id] = kNone;
+    render_world_[id] = mat4(1.0f);
+    render_source_[id] = kNone;
+    render_version_[id] = 0;
+    listed_[id] = 0;
+
+    if (dirty_levels_.empty())
+    {
+      dirty_levels_.resize(1);
+    }
+    depth_[id] = 0;
+    dirty_levels_[0].push_back(id);
+    return id;
   }
 
-  void System::Transform::renderUpdate()
+  void System::Transform::set_parent(uint32 id, uint32 parent)
   {
-    VXR_TRACE_SCOPE("VXR", "Transform Render Update");
-    for (auto &c : components_)
+    const uint32 old_parent = parent_[id];
+    if (old_parent != kNone)
     {
-      if (scene_->id() != c->gameObject()->scene_id())
+      uint32* link = &first_child_[old_parent];
+      while (*link != id)
       {
-        continue;
+        link = &next_sibling_[*link];
+      }
+      *link = next_sibling_[id];
+    }
+
+    parent_[id] = parent;
+    next_sibling_[id] = kNone;
+    if (parent != kNone)
+    {
+      next_sibling_[id] = first_child_[parent];
+      first_child_[parent] = id;
+    }
+    setDepth(id, (parent != kNone) ? depth_[parent] + 1 : 0);
+    // The local transformations kept are relative to the old parent.
+    snapshot_version_[id] = kNone;
+  }
+
+  void System::Transform::setDepth(uint32 id, uint32 depth)
+  {
+    // Moves every slot of the subtree to its new level, the ones marked for update are listed there.
+    stack_.assign(1, id);
+    while (!stack_.empty())
+    {
+      const uint32 node = stack_.back();
+      stack_.pop_back();
+      const uint32 node_depth = (node == id) ? depth : depth_[parent_[node]] + 1;
+
+      if (dirty_levels_.size() <= node_depth)
+      {
+        dirty_levels_.resize(node_depth + 1);
       }
-      if (c->hasChanged())
+      depth_[node] = node_depth;
+      if (dirty_[node])
       {
-        c->updateWorldTransform();
+        dirty_levels_[node_depth].push_back(node);
+      }
+
+      for (uint32 c = first_child_[node]; c != kNone; c = next_sibling_[c])
+      {
+        stack_.push_back(c);
       }
     }
+  }
 
-    /// TODO: Remove this and embed rotation in shader
-    if (scene_->skybox() != nullptr)
+  void System::Transform::markForUpdate(uint32 id)
+  {
+    // Subtrees already marked are skipped, their descendants were marked along with them.
+    stack_.assign(1, id);
+    while (!stack_.empty())
     {
-      ref_ptr<vxr::Transform> skybox = scene_->skybox()->getComponent<vxr::Transform>();
-      if (skybox->hasChanged())
+      const uint32 node = stack_.back();
+      stack_.pop_back();
+      if (dirty_[node])
+      {
+        continue;
+      }
+
+      dirty_[node] = 1;
+      dirty_levels_[depth_[node]].push_back(node);
+      for (uint32 c = first_child_[node]; c != kNone; c = next_sibling_[c])
       {
-        skybox->updateWorldTransform();
+        stack_.push_back(c);
       }
     }
   }
 
+  void System::Transform::update(uint32 id)
+  {
+    VXR_TRACE_SCOPE("VXR", "Compute Transformations");
+    // Changed ancestors are gathered bottom-up and computed top-down.
+    stack_.assign(1, id);
+    for (uint32 parent = parent_[id]; parent != kNone && dirty_[parent]; parent = parent_[parent])
+    {
+      stack_.push_back(parent);
+    }
+    while (!stack_.empty())
+    {
+      record(stack_.back());
+      compute(stack_.back());
+      stack_.pop_back();
+    }
+  }
+
+  void System::Transform::compute(uint32 id)
+  {
+    const uint32 parent = parent_[id];
+    const mat4* parent_world = (parent != kNone) ? &world_[parent] : &kIdentity;
+    Math::composeTransforms(1, &position_[id], &rotation_[id], &scale_[id], &parent_world, &world_[id]);
+    finish(id);
+  }
+
+  void System::Transform::compute(const uint32* ids, uint32 count)
+  {
+    if (!count)
+    {
+      return;
+    }
+
+    // Sources are gathered from their slots into contiguous arrays for the kernel.
+    vec3 positions[kTransformsPerBatch];
+    quat rotations[kTransformsPerBatch];
+    vec3 scales[kTransformsPerBatch];
+    const mat4* parents[kTransformsPerBatch];
+    mat4 worlds[kTransformsPerBatch];
+    // At least one slot is gathered, which lets the compiler see the arrays are filled before the kernel.
+    uint32 i = 0;
+    do
+    {
+      const uint32 id = ids[i];
+      positions[i] = position_[id];
+      rotations[i] = rotation_[id];
+      scales[i] = scale_[id];
+      parents[i] = (parent_[id] != kNone) ? &world_[parent_[id]] : &kIdentity;
+    } while (++i < count);
+    Math::composeTransforms(count, positions, rotations, scales, parents, worlds);
+    for (i = 0; i < count; ++i)
+    {
+      world_[ids[i]] = worlds[i];
+      finish(ids[i]);
+    }
+  }
+
+  void System::Transform::interpolate(const uint32* ids, uint32 count)
+  {
+    if (!count)
+    {
+      return;
+    }
+
+    vec3 positions[kTransformsPerBatch];
+    quat rotations[kTransformsPerBatch];
+    vec3 scales[kTransformsPerBatch];
+    const mat4* parents[kTransformsPerBatch];
+    mat4 worlds[kTransformsPerBatch];
+    // At least one slot is gathered, which lets the compiler see the arrays are filled before the kernel.
+    uint32 i = 0;
+    do
+    {
+      const uint32 id = ids[i];
+      const float t = (snapshot_version_[id] != kNone) ? step_fraction_ : 1.0f;
+      positions[i] = glm::mix(previous_position_[id], position_[id], t);
+      rotations[i] = glm::slerp(previous_rotation_[id], rotation_[id], t);
+      scales[i] = glm::mix(previous_scale_[id], scale_[id], t);
+      parents[i] = (parent_[id] != kNone) ? &render_world_[parent_[id]] : &kIdentity;
+    } while (++i < count);
+    Math::composeTransforms(count, positions, rotations, scales, parents, worlds);
+    for (i = 0; i < count; ++i)
+    {
+      render_world_[ids[i]] = worlds[i];
+      render_source_[ids[i]] = kNone;
+      render_version_[ids[i]]++;
+    }
+  }
+
+  void System::Transform::finish(uint32 id)
+  {
+    const uint32 parent = parent_[id];
+    if (parent == kNone)
+    {
+      world_position_[id] = position_[id];
+      world_rotation_[id] = rotation_[id];
+      world_scale_[id] = scale_[id];
+    }
+    else
+    {
+      world_position_[id] = world_[id][3];
+      world_rotation_[id] = world_rotation_[parent] * rotation_[id];
+      world_scale_[id] = world_scale_[parent] * scale_[id];
+    }
+    dirty_[id] = 0;
+    version_[id]++;
+  }
+
+  void System::Transform::record(uint32 id)
+  {
+    if (interpolation_)
+    {
+      List(id, kStepListed, &listed_, &step_slots_);
+    }
+    else
+    {
+      List(id, kRenderListed, &listed_, &render_slots_);
+    }
+  }
+
   ref_ptr<System::Transform> System::Getter<Transform>::get()
   {
     return Engine::ref().transform();
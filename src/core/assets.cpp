@@ -29,6 +29,7 @@
 #include "../../include/components/renderer.h"
 #include "../../include/components/mesh_filter.h"
 #include "../../include/graphics/texture.h"
+#include "../../include/graphics/mesh_lod.h"
 #include "../../include/graphics/materials/standard.h"
 #include "../../include/graphics/materials/skybox.h"
 #include "../../include/graphics/materials/unlit.h"
@@ -559,6 +560,24 @@ namespace vxr
     return m;
   }
 
+  ref_ptr<MeshLOD> AssetManager::loadMeshLOD(const char* file, uint32 mesh_index)
+  {
+    ref_ptr<Mesh> m = loadMesh(file, mesh_index);
+    for (uint32 i = 0; i < mesh_lods_.size(); ++i)
+    {
+      if (mesh_lods_[i]->source() == m)
+      {
+        return mesh_lods_[i];
+      }
+    }
+
+    // Chains are kept here, so that they outlive their generation tasks.
+    ref_ptr<MeshLOD> lod;
+    lod.alloc()->set_source(m, string(file) + (mesh_index ? "." + std::to_string(mesh_index) : "") + ".lod");
+    mesh_lods_.push_back(lod);
+    return lod;
+  }
+
   ref_ptr<Mesh> AssetManager::default_cube() const
   {
     return meshes_[0];
@@ -25,6 +25,7 @@
 #include "../../include/engine/application.h"
 #include "../../include/engine/engine.h"
 #include "../../include/graphics/window.h"
+#include "../../include/components/transform.h"
 
 namespace vxr 
 {
@@ -137,6 +138,8 @@ namespace vxr
 
       num_updates = 0;
       accumulator += deltaTime;
+      ref_ptr<System::Transform> transform = Engine::ref().transform();
+      transform->set_interpolation(framerate_.interpolate);
       VXR_TRACE_BEGIN("VXR", "Loop Update");
       preUpdate();
       while (accumulator > framerate_.time_step)
@@ -147,6 +150,7 @@ namespace vxr
           break;
         }
         VXR_TRACE_BEGIN("VXR", "App Update");
+        transform->snapshot();
         update(this->deltaTime());
         VXR_TRACE_END("VXR", "App Update");
         accumulator -= framerate_.time_step;
@@ -156,6 +160,7 @@ namespace vxr
       VXR_TRACE_END("VXR", "Loop Update");
       
       VXR_TRACE_BEGIN("VXR", "Render Update");
+      transform->set_step_fraction((float)(accumulator / framerate_.time_step));
       renderPreUpdate();
       renderUpdate();
       renderPostUpdate();
@@ -184,6 +189,11 @@ namespace vxr
     framerate_.max_steps = steps;
   }
 
+  void Application::set_render_interpolation(bool enabled)
+  {
+    framerate_.interpolate = enabled;
+  }
+
   float Application::deltaTime()
   {
     return (float)framerate_.time_step;
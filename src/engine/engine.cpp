@@ -24,7 +24,7 @@
 
 #include "../../include/engine/engine.h"
 
-#include "../../include/engine/GPU.h"
+#include "../../include/engine/gpu.h"
 #include "../../include/core/scene.h"
 #include "../../include/core/assets.h"
 
@@ -79,7 +79,9 @@ namespace vxr
     VXR_TRACE_BEGIN("VXR", "Engine Systems Init");
     VXR_LOG(VXR_DEBUG_LEVEL_DEBUG, "[DEBUG]: [ENGINE] Initializing engine systems.\n");
 #ifdef VXR_THREADING
-    scheduler_.init();
+    threading::SchedulerParams scheduler_params;
+    scheduler_params.max_running_threads = (uint16_t)preinit_params_.scheduler.max_running_threads;
+    scheduler_.init(scheduler_params);
 #endif
     ibl_.alloc();
     light_.alloc();
@@ -178,6 +180,7 @@ namespace vxr
     transform_->renderUpdate();
     ibl_->renderUpdate();
     camera_->renderUpdate();
+    light_->renderUpdate();
     renderer_->renderUpdate();
     VXR_TRACE_END("VXR", "Systems Render Update");
   }
@@ -234,6 +237,46 @@ namespace vxr
     gpu_->moveOrAppendCommands(std::move(dl));
   }
 
+  void Engine::submitParallelDisplayLists(uint32 num_chunks, std::function<void(uint32 chunk, DisplayList& dl)> record)
+  {
+    VXR_TRACE_SCOPE("VXR", "Parallel Display Lists");
+    while (display_list_chunks_.size() < num_chunks)
+    {
+      scoped_ptr<DisplayList> dl;
+      dl.alloc();
+      display_list_chunks_.push_back(std::move(dl));
+    }
+
+    // Every worker records into its own chunk, so no lock is needed while recording.
+    runParallel(num_chunks, [this, &record](uint32 i) { record(i, *display_list_chunks_[i]); });
+
+    // Chunks are merged in chunk order, the result does not depend on worker scheduling.
+    for (uint32 i = 0; i < num_chunks; ++i)
+    {
+      gpu_->moveOrAppendCommands(std::move(*display_list_chunks_[i]));
+    }
+  }
+
+  void Engine::runParallel(uint32 num_jobs, std::function<void(uint32 job)> job)
+  {
+#ifdef VXR_THREADING
+    if (num_jobs > 1)
+    {
+      threading::Sync sync;
+      for (uint32 i = 0; i < num_jobs; ++i)
+      {
+        scheduler_.run([&job, i]() { job(i); }, &sync);
+      }
+      scheduler_.waitFor(sync);
+      return;
+    }
+#endif
+    for (uint32 i = 0; i < num_jobs; ++i)
+    {
+      job(i);
+    }
+  }
+
   void Engine::submitUIFunction(std::function<void()> function)
   {
 #ifdef VXR_UI
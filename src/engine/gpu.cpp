@@ -25,6 +25,18 @@
 #include "../../include/engine/gpu.h"
 #include "../../include/engine/engine.h"
 
+#if defined (VXR_OPENGL)
+#  include "../graphics/backend/opengl/gl_backend.h"
+#elif defined (VXR_DX11)
+#  include "../graphics/backend/dx11/dx11_backend.h"
+#elif defined (VXR_NULL)
+#  include "../graphics/backend/null/null_backend.h"
+#else
+#  error Backend must be defined on GENie.lua (e.g. try parameters --gl, --dx11 OR --null).
+#endif
+
+#include <chrono>
+
 namespace vxr 
 {
   GPU::GPU()
@@ -32,8 +44,17 @@ namespace vxr
     set_name("GPU");
     ctx_ = new RenderContext();
     window_.alloc();
+    mesh_arena_.alloc();
     logic_frame_.alloc();
     is_exiting_ = false;
+#ifdef VXR_THREADING
+    thread_data_.write_index = 0;
+    thread_data_.read_index = 0;
+#endif
+    logic_wait_ms_ = 0.0f;
+    render_wait_ms_ = 0.0f;
+    logic_stalls_ = 0;
+    render_stalls_ = 0;
 	}
 
 	GPU::~GPU() 
@@ -47,8 +68,10 @@ namespace vxr
 #ifndef VXR_THREADING
     window_->init();
 #else
+    thread_data_.num_frames = glm::clamp(params_.frames_in_flight, (uint32)1, (uint32)kMaxFramesInFlight);
+    // Logged before the render thread starts, the log is not meant to be written by two threads at once.
+    VXR_LOG(VXR_DEBUG_LEVEL_INFO, "[INFO]: [GPU] Launched rendering thread (VXR_THREADING, %u frames in flight).\n", thread_data_.num_frames);
     thread_data_.thread = std::thread(&vxr::GPU::run, this);
-    VXR_LOG(VXR_DEBUG_LEVEL_INFO, "[INFO]: [GPU] Launched rendering thread (VXR_THREADING).\n");
     std::unique_lock<std::mutex> lock(thread_data_.mx_l);
     thread_data_.cv_l.wait(lock, [this] { return thread_data_.initialized; });
 #endif
@@ -58,7 +81,9 @@ namespace vxr
   {
 #ifndef VXR_THREADING
     window_->events();
-    render_frame_.update();
+    DisplayList::FrameStats frame_stats;
+    render_frame_.update(&frame_stats);
+    publishFrameStats(frame_stats);
     window_->swap();
 #endif
   }
@@ -66,67 +91,127 @@ namespace vxr
   void GPU::stop()
   {
 #ifndef VXR_THREADING
+    releaseResources(frame_index_, true);
     window_->stop();
 #else
     thread_data_.thread.join();
     VXR_LOG(VXR_DEBUG_LEVEL_INFO, "[INFO]: [GPU] Joined rendering thread (VXR_THREADING).\n");
+#endif
+    VXR_LOG(VXR_DEBUG_LEVEL_INFO, "[INFO]: [GPU] Resource pools (used / peak / size):\n    - buffers           (%u / %u / %u)\n    - textures          (%u / %u / %u)\n    - materials         (%u / %u / %u)\n    - framebuffers      (%u / %u / %u)\n",
+      num_used_buffers(), peak_used_buffers(), num_buffers(),
+      num_used_textures(), peak_used_textures(), num_textures(),
+      num_used_materials(), peak_used_materials(), num_materials(),
+      num_used_framebuffers(), peak_used_framebuffers(), num_framebuffers());
+    Stats s = stats();
+    VXR_LOG(VXR_DEBUG_LEVEL_INFO, "[INFO]: [GPU] Resource memory (current / peak):\n    - buffers           (%llu / %llu bytes)\n    - textures          (%llu / %llu bytes)\n    - frame uploads     (peak %llu bytes)\n",
+      (unsigned long long)s.buffers.bytes, (unsigned long long)s.buffers.peak_bytes,
+      (unsigned long long)s.textures.bytes, (unsigned long long)s.textures.peak_bytes,
+      (unsigned long long)s.peak_frame_upload_bytes);
+#ifdef VXR_NULL
+    gpu::LogStats();
 #endif
   }
 
 #ifdef VXR_THREADING
+  // Spins for a while, then yields and finally sleeps, so that a waiting thread does not burn a whole core.
+  static void Backoff(uint32 iteration)
+  {
+    if (iteration < 64)
+    {
+      return;
+    }
+    if (iteration < 256)
+    {
+      std::this_thread::yield();
+      return;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+
+  static float ElapsedMs(std::chrono::high_resolution_clock::time_point start)
+  {
+    return std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+  }
+
   void GPU::run()
   {
     VXR_TRACE_META_THREAD_NAME("Render Thread");
     window_->init();
 
-    thread_data_.initialized = true;
+    {
+      std::unique_lock<std::mutex> lock(thread_data_.mx_l);
+      thread_data_.initialized = true;
+    }
     thread_data_.cv_l.notify_one();
 
     VXR_TRACE_BEGIN("VXR", "Frame");
-    VXR_TRACE_BEGIN("VXR", "WAITING (Render)");
 
     while (!(is_exiting_ = window_->is_exiting()))
     {
-      VXR_LOG(VXR_DEBUG_LEVEL_DEBUG, "[DEBUG]: [GPU] GPU Synchronization (Render Waiting).\n");
-      std::unique_lock<std::mutex> lock(thread_data_.mx_r);
-      thread_data_.cv_r.wait(lock, [this] { return render_frame_.commands_.empty() /*&& !thread_data_.next_frame.commands_.empty()*/; });
-
-      if (!thread_data_.next_frame.commands_.empty())
+      uint32 read = thread_data_.read_index.load(std::memory_order_relaxed);
+      if (read == thread_data_.write_index.load(std::memory_order_acquire))
       {
-        VXR_TRACE_END("VXR", "WAITING (Render)");
-        VXR_LOG(VXR_DEBUG_LEVEL_DEBUG, "[DEBUG]: [GPU] GPU Synchronization (Render Start).\n");
-        window_->events();
-        render_frame_.commands_.swap(thread_data_.next_frame.commands_);
-
-        thread_data_.cv_l.notify_one();
-        VXR_LOG(VXR_DEBUG_LEVEL_DEBUG, "[DEBUG]: [GPU] GPU Synchronization (Render Ready).\n");
-
-        render_frame_.update();
-        window_->swap();
-        VXR_TRACE_END("VXR", "Frame");
-        VXR_TRACE_BEGIN("VXR", "Frame");
         VXR_TRACE_BEGIN("VXR", "WAITING (Render)");
+        VXR_LOG(VXR_DEBUG_LEVEL_DEBUG, "[DEBUG]: [GPU] GPU Synchronization (Render Waiting).\n");
+        auto start = std::chrono::high_resolution_clock::now();
+        uint32 iteration = 0;
+        while (read == thread_data_.write_index.load(std::memory_order_acquire))
+        {
+          Backoff(iteration++);
+        }
+        render_wait_ms_ = ElapsedMs(start);
+        render_stalls_++;
+        VXR_TRACE_END("VXR", "WAITING (Render)");
       }
       else
       {
-        thread_data_.cv_l.notify_one();
-        VXR_LOG(VXR_DEBUG_LEVEL_DEBUG, "[DEBUG]: [GPU] GPU Synchronization (Render Ready).\n");
+        render_wait_ms_ = 0.0f;
       }
+
+      VXR_LOG(VXR_DEBUG_LEVEL_DEBUG, "[DEBUG]: [GPU] GPU Synchronization (Render Start).\n");
+      window_->events();
+
+      // The consumed slot receives the (empty) pages of the last rendered frame.
+      render_frame_.swap(thread_data_.frames[read % thread_data_.num_frames]);
+      thread_data_.read_index.store(read + 1, std::memory_order_release);
+      VXR_LOG(VXR_DEBUG_LEVEL_DEBUG, "[DEBUG]: [GPU] GPU Synchronization (Render Ready).\n");
+
+      DisplayList::FrameStats frame_stats;
+      render_frame_.update(&frame_stats);
+      publishFrameStats(frame_stats);
+      releaseResources(read);
+      window_->swap();
+      VXR_TRACE_END("VXR", "Frame");
+      VXR_TRACE_BEGIN("VXR", "Frame");
     }
 
-    VXR_TRACE_END("VXR", "WAITING (Render)");
     VXR_TRACE_END("VXR", "Frame");
 
+    // No frame will be executed anymore, backend objects are freed while the context is still alive.
+    releaseResources(0, true);
     window_->stop();
-    thread_data_.cv_l.notify_one();
   }
 
   void GPU::prepareRender()
   {
+    uint32 write = thread_data_.write_index.load(std::memory_order_relaxed);
+    if (write - thread_data_.read_index.load(std::memory_order_acquire) < thread_data_.num_frames)
+    {
+      logic_wait_ms_ = 0.0f;
+      VXR_LOG(VXR_DEBUG_LEVEL_DEBUG, "[DEBUG]: [GPU] GPU Synchronization (Logic Start).\n");
+      return;
+    }
+
     VXR_TRACE_BEGIN("VXR", "WAITING (Logic)");
     VXR_LOG(VXR_DEBUG_LEVEL_DEBUG, "[DEBUG]: [GPU] GPU Synchronization (Logic Waiting).\n");
-    std::unique_lock<std::mutex> lock(thread_data_.mx_l);
-    thread_data_.cv_l.wait(lock, [this] { return is_exiting_ || thread_data_.next_frame.commands_.empty(); });
+    auto start = std::chrono::high_resolution_clock::now();
+    uint32 iteration = 0;
+    while (!is_exiting_ && write - thread_data_.read_index.load(std::memory_order_acquire) >= thread_data_.num_frames)
+    {
+      Backoff(iteration++);
+    }
+    logic_wait_ms_ = ElapsedMs(start);
+    logic_stalls_++;
     VXR_TRACE_END("VXR", "WAITING (Logic)");
     VXR_LOG(VXR_DEBUG_LEVEL_DEBUG, "[DEBUG]: [GPU] GPU Synchronization (Logic Start).\n");
   }
@@ -137,31 +222,35 @@ namespace vxr
 #ifdef VXR_THREADING
     if (logic_frame_ != NULL)
     {
-      thread_data_.next_frame.commands_ = std::move(logic_frame_->commands_);
+      uint32 write = thread_data_.write_index.load(std::memory_order_relaxed);
+      if (write - thread_data_.read_index.load(std::memory_order_acquire) < thread_data_.num_frames)
+      {
+        // Swapping hands the already allocated (and now empty) pages back to the logic frame.
+        thread_data_.frames[write % thread_data_.num_frames].swap(*logic_frame_);
+        thread_data_.write_index.store(write + 1, std::memory_order_release);
+      }
+      else
+      {
+        // Only reachable while exiting, the render thread will not consume more frames.
+        logic_frame_->reset();
+      }
     }
-    thread_data_.cv_r.notify_one();
     VXR_LOG(VXR_DEBUG_LEVEL_DEBUG, "[DEBUG]: [GPU] GPU Synchronization (Logic Ready).\n");
 #else
     if (logic_frame_ != NULL)
     {
-      render_frame_.commands_ = std::move(logic_frame_->commands_);
+      render_frame_.swap(*logic_frame_);
     }
     update();
+    releaseResources(frame_index_);
+    frame_index_++;
 #endif
   }
 
   void GPU::moveOrAppendCommands(DisplayList &&dl)
   {
-    if (logic_frame_->commands_.empty())
-    {
-      logic_frame_->commands_ = std::move(dl.commands_);
-    }
-    else
-    {
-      logic_frame_->commands_.reserve(logic_frame_->commands_.size() + dl.commands_.size());
-      std::move(std::begin(dl.commands_), std::end(dl.commands_), std::back_inserter(logic_frame_->commands_));
-      dl.commands_.clear();
-    }
+    // Commands are POD, so appending them is a plain copy into the logic frame pages.
+    logic_frame_->append(dl);
   }
   
 // ----------------------------------------------------------------------------------------
@@ -169,34 +258,18 @@ namespace vxr
 //  by Jose L. Hidalgo (PpluX), and later modified to fit vxr needs.
 //  Link: https://github.com/pplux/px/blob/master/px_render.h
 
-  template<class T>
-  static uint32 AcquireResource(scoped_array<T>* pool) 
+  gpu::Buffer GPU::createBuffer(const gpu::Buffer::Info& info)
   {
-    uint32 try_count = 10;
-    while (try_count--) 
+    uint32 id = ctx_->AcquireResource(&ctx_->buffers_, &ctx_->free_buffers_, gpu::Resource::Type::Buffer);
+    if (!id)
     {
-      for (uint32 i = 0; i < pool->size(); ++i) 
-      {
-        if ((*pool)[i].acquire()) 
-        {
-          uint32 version = (*pool)[i].version;
-          uint32 result = i | (version << 20);
-          return result;
-        }
-      }
+      VXR_LOG(VXR_DEBUG_LEVEL_ERROR, "[ERROR]: [GPU] Could not create buffer.\n");
+      return gpu::Buffer();
     }
-    VXR_LOG(VXR_DEBUG_LEVEL_ERROR, "[ERROR]: [GPU] Assigned id 0 to resource instance.\n");
-    return 0;
-  }
-
-  gpu::Buffer GPU::createBuffer(const gpu::Buffer::Info& info)
-  {
-    uint32 id = AcquireResource(&ctx_->buffers_);
     uint32 pos = RenderContext::index(id);
     gpu::BufferInstance &inst = ctx_->buffers_[pos];
     inst.info = info;
-
-    num_used_buffers_++;
+    RenderContext::SetInstanceMemory(&inst, info.size_, &ctx_->buffer_memory_);
 
     return gpu::Buffer{ ctx_,id };
   }
@@ -209,8 +282,13 @@ namespace vxr
       return gpu::Texture();
     }
 
-    uint32_t id = AcquireResource(&ctx_->textures_);
-    uint32_t pos = RenderContext::index(id);
+    uint32 id = ctx_->AcquireResource(&ctx_->textures_, &ctx_->free_textures_, gpu::Resource::Type::Texture);
+    if (!id)
+    {
+      VXR_LOG(VXR_DEBUG_LEVEL_ERROR, "[ERROR]: [GPU] Could not create texture.\n");
+      return gpu::Texture();
+    }
+    uint32 pos = RenderContext::index(id);
     gpu::TextureInstance &i_obj = ctx_->textures_[pos];
     i_obj.info = info;
 
@@ -234,9 +312,27 @@ namespace vxr
     case TexelsFormat::DepthStencil_U16:
       i_obj.bytes_per_pixel = 4;
       break;
+    case TexelsFormat::R_F16:
+      i_obj.bytes_per_pixel = 2;
+      break;
+    case TexelsFormat::RG_F16:
+      i_obj.bytes_per_pixel = 4;
+      break;
+    case TexelsFormat::RGB_F16:
+      i_obj.bytes_per_pixel = 6;
+      break;
+    case TexelsFormat::RGBA_F16:
+      i_obj.bytes_per_pixel = 8;
+      break;
+    case TexelsFormat::Depth_U24:
+    case TexelsFormat::DepthStencil_U24:
+      i_obj.bytes_per_pixel = 4;
+      break;
+    default:
+      i_obj.bytes_per_pixel = 0;
+      break;
     }
-
-    num_used_textures_++;
+    RenderContext::SetInstanceMemory(&i_obj, RenderContext::TextureMemory(i_obj, false), &ctx_->texture_memory_);
 
     return gpu::Texture{ ctx_, id };
   }
@@ -265,7 +361,12 @@ namespace vxr
 
   gpu::Material GPU::createMaterial(const gpu::Material::Info &info)
   {
-    uint32 id = AcquireResource(&ctx_->materials_);
+    uint32 id = ctx_->AcquireResource(&ctx_->materials_, &ctx_->free_materials_, gpu::Resource::Type::Material);
+    if (!id)
+    {
+      VXR_LOG(VXR_DEBUG_LEVEL_ERROR, "[ERROR]: [GPU] Could not create material.\n");
+      return gpu::Material();
+    }
     uint32 pos = ctx_->index(id);
     gpu::MaterialInstance &inst = ctx_->materials_[pos];
     inst.info = info;
@@ -302,68 +403,279 @@ namespace vxr
       }
     }
 
-    num_used_materials_++;
-
     return gpu::Material{ ctx_, id };
   }
 
   gpu::Framebuffer GPU::createFramebuffer(const gpu::Framebuffer::Info &info)
   {
-    uint32 id = AcquireResource(&ctx_->framebuffers_);
+    uint32 id = ctx_->AcquireResource(&ctx_->framebuffers_, &ctx_->free_framebuffers_, gpu::Resource::Type::Framebuffer);
+    if (!id)
+    {
+      VXR_LOG(VXR_DEBUG_LEVEL_ERROR, "[ERROR]: [GPU] Could not create framebuffer.\n");
+      return gpu::Framebuffer();
+    }
     uint32 pos = RenderContext::index(id);
     gpu::FramebufferInstance &i_obj = ctx_->framebuffers_[pos];
     i_obj.info = info;
-    for (uint32 i = 0; i < info.num_color_textures; ++i) 
+    for (uint32 i = 0; i < kMaxFramebufferColorTextures; ++i) 
     {
-      i_obj.color_textures[i] = createTexture(info.color_texture_info[i]);
+      i_obj.color_textures[i] = (i < info.num_color_textures) ? createTexture(info.color_texture_info[i]) : gpu::Texture();
     }
     i_obj.depth_texture = createTexture(info.depth_stencil_texture_info);
 
-    num_used_framebuffers_++;
-
     return gpu::Framebuffer{ ctx_, id };
   }
 
+// ----------------------------------------------------------------------------------------
+
+  void GPU::destroyBuffer(gpu::Buffer buffer)
+  {
+    destroyResource(buffer);
+  }
+
+  void GPU::destroyTexture(gpu::Texture texture)
+  {
+    destroyResource(texture);
+  }
+
+  void GPU::destroyMaterial(gpu::Material material)
+  {
+    destroyResource(material);
+  }
+
+  void GPU::destroyFramebuffer(gpu::Framebuffer framebuffer)
+  {
+    if (!framebuffer.ctx || !RenderContext::CheckValidResource(framebuffer.id, &ctx_->framebuffers_))
+    {
+      return;
+    }
+    gpu::FramebufferInstance &i_obj = ctx_->framebuffers_[RenderContext::index(framebuffer.id)];
+    for (uint32 i = 0; i < kMaxFramebufferColorTextures; ++i)
+    {
+      destroyResource(i_obj.color_textures[i]);
+    }
+    destroyResource(i_obj.depth_texture);
+    destroyResource(framebuffer);
+  }
+
+  uint32 GPU::recording_frame() const
+  {
+#ifdef VXR_THREADING
+    return thread_data_.write_index.load(std::memory_order_relaxed);
+#else
+    return frame_index_;
+#endif
+  }
+
+  void GPU::destroyResource(const gpu::Resource& resource)
+  {
+    if (!resource.ctx || !resource.id)
+    {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(release_mx_);
+    pending_releases_.push_back({ resource, recording_frame() });
+  }
+
+  void GPU::releaseData(std::shared_ptr<const void> data)
+  {
+    if (!data)
+    {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(release_mx_);
+    pending_data_.push_back({ std::move(data), recording_frame() });
+  }
+
+  void GPU::releaseResources(uint32 frame, bool all)
+  {
+    {
+      std::lock_guard<std::mutex> lock(release_mx_);
+      uint32 data_count = 0;
+      while (data_count < pending_data_.size() && (all || (int32)(frame - pending_data_[data_count].frame) >= 0))
+      {
+        data_count++;
+      }
+      pending_data_.erase(pending_data_.begin(), pending_data_.begin() + data_count);
+
+      // Entries are pushed in frame order, so the ones ready to be released are at the front.
+      uint32 count = 0;
+      while (count < pending_releases_.size() && (all || (int32)(frame - pending_releases_[count].frame) >= 0))
+      {
+        count++;
+      }
+      if (!count)
+      {
+        return;
+      }
+      releasing_.assign(pending_releases_.begin(), pending_releases_.begin() + count);
+      pending_releases_.erase(pending_releases_.begin(), pending_releases_.begin() + count);
+    }
+
+    VXR_TRACE_SCOPE("VXR", "Release Resources");
+    for (auto& r : releasing_)
+    {
+      const gpu::Resource& res = r.resource;
+      // Destroying twice is harmless, the second entry no longer matches the slot version.
+      switch (res.type)
+      {
+      case gpu::Resource::Type::Buffer:
+        if (!RenderContext::CheckValidResource(res.id, &ctx_->buffers_)) continue;
+        gpu::DestroyResource(res);
+        RenderContext::SetInstanceMemory(&ctx_->buffers_[RenderContext::index(res.id)], 0, &ctx_->buffer_memory_);
+        RenderContext::ReleaseResource(res.id, &ctx_->buffers_, &ctx_->free_buffers_);
+        break;
+      case gpu::Resource::Type::Texture:
+        if (!RenderContext::CheckValidResource(res.id, &ctx_->textures_)) continue;
+        gpu::DestroyResource(res);
+        RenderContext::SetInstanceMemory(&ctx_->textures_[RenderContext::index(res.id)], 0, &ctx_->texture_memory_);
+        RenderContext::ReleaseResource(res.id, &ctx_->textures_, &ctx_->free_textures_);
+        break;
+      case gpu::Resource::Type::Material:
+        if (!RenderContext::CheckValidResource(res.id, &ctx_->materials_)) continue;
+        gpu::DestroyResource(res);
+        RenderContext::ReleaseResource(res.id, &ctx_->materials_, &ctx_->free_materials_);
+        break;
+      case gpu::Resource::Type::Framebuffer:
+        if (!RenderContext::CheckValidResource(res.id, &ctx_->framebuffers_)) continue;
+        gpu::DestroyResource(res);
+        RenderContext::ReleaseResource(res.id, &ctx_->framebuffers_, &ctx_->free_framebuffers_);
+        break;
+      default:
+        break;
+      }
+    }
+    releasing_.clear();
+  }
+
 // ----------------------------------------------------------------------------------------
 
   uint32 GPU::num_buffers() const
   {
-    return params_.max_buffers;
+    return (uint32)ctx_->buffers_.size();
   }
 
   uint32 GPU::num_textures() const
   {
-    return params_.max_textures;
+    return (uint32)ctx_->textures_.size();
   }
 
   uint32 GPU::num_materials() const
   {
-    return params_.max_materials;
+    return (uint32)ctx_->materials_.size();
   }
 
   uint32 GPU::num_framebuffers() const
   {
-    return params_.max_framebuffers;
+    return (uint32)ctx_->framebuffers_.size();
   }
 
   uint32 GPU::num_used_buffers() const
   {
-    return num_used_buffers_;
+    return ctx_->free_buffers_.used();
+  }
+
+  uint32 GPU::peak_used_buffers() const
+  {
+    return ctx_->free_buffers_.high_water();
   }
 
   uint32 GPU::num_used_textures() const
   {
-    return num_used_textures_;
+    return ctx_->free_textures_.used();
+  }
+
+  uint32 GPU::peak_used_textures() const
+  {
+    return ctx_->free_textures_.high_water();
   }
 
   uint32 GPU::num_used_materials() const
   {
-    return num_used_materials_;
+    return ctx_->free_materials_.used();
+  }
+
+  uint32 GPU::peak_used_materials() const
+  {
+    return ctx_->free_materials_.high_water();
   }
 
   uint32 GPU::num_used_framebuffers() const
   {
-    return num_used_framebuffers_;
+    return ctx_->free_framebuffers_.used();
+  }
+
+  uint32 GPU::peak_used_framebuffers() const
+  {
+    return ctx_->free_framebuffers_.high_water();
+  }
+
+  void GPU::publishFrameStats(const DisplayList::FrameStats& frame)
+  {
+    std::lock_guard<std::mutex> lock(stats_mx_);
+    last_frame_stats_ = frame;
+    peak_frame_upload_bytes_ = glm::max(peak_frame_upload_bytes_, frame.fill_buffer_bytes + frame.fill_texture_bytes);
+    frames_rendered_++;
+  }
+
+  static GPU::Stats::Pool PoolStats(uint32 used, uint32 peak_used, uint32 size, const RenderContext::Memory* memory)
+  {
+    GPU::Stats::Pool pool;
+    pool.used = used;
+    pool.peak_used = peak_used;
+    pool.size = size;
+    pool.bytes = (memory) ? memory->bytes.load() : 0;
+    pool.peak_bytes = (memory) ? memory->peak_bytes.load() : 0;
+    return pool;
+  }
+
+  GPU::Stats GPU::stats() const
+  {
+    Stats s;
+    s.buffers = PoolStats(num_used_buffers(), peak_used_buffers(), num_buffers(), &ctx_->buffer_memory_);
+    s.textures = PoolStats(num_used_textures(), peak_used_textures(), num_textures(), &ctx_->texture_memory_);
+    s.materials = PoolStats(num_used_materials(), peak_used_materials(), num_materials(), nullptr);
+    s.framebuffers = PoolStats(num_used_framebuffers(), peak_used_framebuffers(), num_framebuffers(), nullptr);
+
+    std::lock_guard<std::mutex> lock(stats_mx_);
+    s.frame = last_frame_stats_;
+    s.peak_frame_upload_bytes = peak_frame_upload_bytes_;
+    s.frames = frames_rendered_;
+    return s;
+  }
+
+  ref_ptr<MeshArena> GPU::meshArena()
+  {
+    return mesh_arena_;
+  }
+
+  uint32 GPU::frames_in_flight() const
+  {
+#ifdef VXR_THREADING
+    return thread_data_.num_frames;
+#else
+    return 0;
+#endif
+  }
+
+  float GPU::logic_wait_ms() const
+  {
+    return logic_wait_ms_;
+  }
+
+  float GPU::render_wait_ms() const
+  {
+    return render_wait_ms_;
+  }
+
+  uint32 GPU::logic_stalls() const
+  {
+    return logic_stalls_;
+  }
+
+  uint32 GPU::render_stalls() const
+  {
+    return render_stalls_;
   }
 
 } /* end of vxr namespace */
\ No newline at end of file
@@ -84,6 +84,16 @@ namespace vxr
     static GLenum Translate(BlendOp::Enum e);
     static GLenum Translate(CompareFunc::Enum e);*/
 
+    void BeginUploads(RenderContext* ctx, uint32 size)
+    {
+
+    }
+
+    void Upload(RenderContext* ctx, uint32 offset, const void* data, uint32 size)
+    {
+
+    }
+
     void ClearScreen(const DisplayList::ClearData& d)
     {
 
@@ -127,6 +137,11 @@ namespace vxr
     void Render(DisplayList::RenderData& d)
     {
       
+    }
+
+    void DestroyResource(const Resource& r)
+    {
+
     }
     /*
     static GLenum TranslateVertexType(uint32 format)
@@ -69,21 +69,26 @@ namespace vxr
 
       };
 
-      scoped_array<Buffer>      buffers;
-      scoped_array<Texture>     textures;
-      scoped_array<Material>    materials;
-      scoped_array<Framebuffer> framebuffers;
+      paged_array<Buffer>      buffers;
+      paged_array<Texture>     textures;
+      paged_array<Material>    materials;
+      paged_array<Framebuffer> framebuffers;
     };
 
     void InitBackEnd(BackEnd** back_end, const Params::GPU &params = Params::GPU());
     void DestroyBackEnd(BackEnd** back_end);
 
+    void BeginUploads(RenderContext* ctx, uint32 size);
+    void Upload(RenderContext* ctx, uint32 offset, const void* data, uint32 size);
+
     void ClearScreen(const DisplayList::ClearData& d);
     void FillBuffer(DisplayList::FillBufferData& d);
     void FillTexture(DisplayList::FillTextureData& d);
     void SetupMaterial(DisplayList::SetupMaterialData& d);
     void SetupView(DisplayList::SetupViewData& d);
     void Render(DisplayList::RenderData& d);
+    // Frees the backend objects of a resource, called by the render thread once no frame uses it.
+    void DestroyResource(const Resource& r);
 
   } /* end of gpu namespace */
 
@@ -0,0 +1,240 @@
+// ----------------------------------------------------------------------------------------
+// MIT License
+// 
+// Copyright(c) 2018 Vctor vila
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ----------------------------------------------------------------------------------------
+
+#include "null_backend.h"
+
+#ifdef VXR_NULL
+
+#include "../../../../include/graphics/render_context.h"
+
+namespace vxr
+{
+
+  namespace gpu
+  {
+    // Clear and view commands hold no render context, so they are recorded on the last backend created.
+    static BackEnd* main_back_end = nullptr;
+
+    void InitBackEnd(BackEnd** b, const Params::GPU &params)
+    {
+      *b = new BackEnd();
+      main_back_end = *b;
+
+      (*b)->buffers.alloc(params.max_buffers);
+      (*b)->textures.alloc(params.max_textures);
+      (*b)->materials.alloc(params.max_materials);
+      (*b)->framebuffers.alloc(params.max_framebuffers);
+
+      VXR_LOG(VXR_DEBUG_LEVEL_INFO, "[INFO]: [GPU] Initialized Null backend, nothing will be drawn.\n");
+    }
+
+    void DestroyBackEnd(BackEnd** b)
+    {
+      if (main_back_end == *b)
+      {
+        main_back_end = nullptr;
+      }
+      delete *b;
+      *b = nullptr;
+    }
+
+    void LogStats()
+    {
+      if (!main_back_end)
+      {
+        return;
+      }
+
+      const BackEnd::Stats& s = main_back_end->stats;
+      VXR_LOG(VXR_DEBUG_LEVEL_INFO, "[INFO]: [GPU] Null backend stats:\n"
+        "    - clears              (%u)\n"
+        "    - setup views         (%u, %u framebuffer changes)\n"
+        "    - fill buffers        (%u, %llu bytes, %u reallocations)\n"
+        "    - fill textures       (%u, %llu bytes)\n"
+        "    - uploads             (%u, %llu bytes)\n"
+        "    - setup materials     (%u, %u material changes, %u programs, %u uniform ranges)\n"
+        "    - draws               (%u, %llu indices, %llu instances)\n"
+        "    - destroyed resources (%u)\n",
+        s.clears, s.setup_views, s.framebuffer_changes,
+        s.fill_buffers, (unsigned long long)s.fill_buffer_bytes, s.buffer_reallocations,
+        s.fill_textures, (unsigned long long)s.fill_texture_bytes,
+        s.uploads, (unsigned long long)s.upload_bytes,
+        s.setup_materials, s.material_changes, s.programs_created, s.uniform_ranges,
+        s.draws, (unsigned long long)s.indices, (unsigned long long)s.instances,
+        s.resources_destroyed);
+    }
+
+    void BeginUploads(RenderContext*, uint32)
+    {
+    }
+
+    void Upload(RenderContext* ctx, uint32, const void*, uint32 size)
+    {
+      ctx->back_end_->stats.uploads++;
+      ctx->back_end_->stats.upload_bytes += size;
+    }
+
+    void ClearScreen(const DisplayList::ClearData&)
+    {
+      if (main_back_end)
+      {
+        main_back_end->stats.clears++;
+      }
+    }
+
+    void FillBuffer(DisplayList::FillBufferData& d)
+    {
+      // Resources that failed to be created are still referenced by the commands, skip them.
+      if (!d.buffer.ctx)
+      {
+        return;
+      }
+
+      auto b = RenderContext::GetResource(d.buffer.id, &d.buffer.ctx->buffers_, &d.buffer.ctx->back_end_->buffers);
+      BackEnd::Stats& stats = d.buffer.ctx->back_end_->stats;
+
+      // Same policy as the GL backend, buffers only grow when a fill does not fit in them.
+      uint32 end = d.offset + d.size;
+      if (!b.second->size)
+      {
+        b.first->info.size_ = glm::max(b.first->info.size_, end);
+        b.second->size = b.first->info.size_;
+      }
+      else if (b.second->size < end)
+      {
+        b.second->size = end;
+        b.first->info.size_ = end;
+        stats.buffer_reallocations++;
+      }
+
+      stats.fill_buffers++;
+      stats.fill_buffer_bytes += d.size;
+    }
+
+    void FillTexture(DisplayList::FillTextureData& d)
+    {
+      if (!d.texture.ctx)
+      {
+        return;
+      }
+
+      auto t = RenderContext::GetResource(d.texture.id, &d.texture.ctx->textures_, &d.texture.ctx->back_end_->textures);
+      BackEnd::Stats& stats = d.texture.ctx->back_end_->stats;
+
+      t.second->initialized = true;
+
+      uint32 width = (d.width) ? d.width : t.first->info.width;
+      uint32 height = (d.height) ? d.height : t.first->info.height;
+      uint32 depth = (d.depth) ? d.depth : t.first->info.depth;
+      uint64 face_size = (uint64)width * height * depth * t.first->bytes_per_pixel;
+
+      const void* faces[] = { d.data, d.data_1, d.data_2, d.data_3, d.data_4, d.data_5 };
+      for (uint32 i = 0; i < 6; ++i)
+      {
+        if (faces[i])
+        {
+          stats.fill_texture_bytes += face_size;
+        }
+      }
+      stats.fill_textures++;
+    }
+
+    void SetupMaterial(DisplayList::SetupMaterialData& d)
+    {
+      RenderContext* ctx = d.material.ctx;
+      if (!ctx)
+      {
+        return;
+      }
+
+      bool main_material_changed = !(d.material.id == ctx->main_material.material.id);
+      ctx->main_material = d;
+
+      auto mat = RenderContext::GetResource(d.material.id, &ctx->materials_, &ctx->back_end_->materials);
+      if (!mat.second->initialized)
+      {
+        mat.second->initialized = true;
+        ctx->back_end_->stats.programs_created++;
+      }
+
+      ctx->back_end_->stats.setup_materials++;
+      for (uint32 i = 0; i < kMaxUniformBuffers; ++i)
+      {
+        if (d.uniform_buffer[i].id && d.uniform_buffer_size[i])
+        {
+          ctx->back_end_->stats.uniform_ranges++;
+        }
+      }
+      if (main_material_changed)
+      {
+        ctx->back_end_->stats.material_changes++;
+      }
+    }
+
+    void SetupView(DisplayList::SetupViewData& d)
+    {
+      if (!main_back_end)
+      {
+        return;
+      }
+      main_back_end->stats.setup_views++;
+      if (d.framebuffer.id != main_back_end->current_framebuffer)
+      {
+        main_back_end->current_framebuffer = d.framebuffer.id;
+        main_back_end->stats.framebuffer_changes++;
+      }
+    }
+
+    void Render(DisplayList::RenderData& d)
+    {
+      RenderContext* ctx = d.index_buffer.ctx;
+      if (!ctx)
+      {
+        return;
+      }
+      ctx->back_end_->stats.draws++;
+      ctx->back_end_->stats.indices += (uint64)d.count * d.instances;
+      ctx->back_end_->stats.instances += d.instances;
+    }
+
+    void DestroyResource(const Resource& r)
+    {
+      BackEnd* b = r.ctx->back_end_;
+      uint32 pos = RenderContext::index(r.id);
+      switch (r.type)
+      {
+      case Resource::Type::Buffer:      b->buffers[pos] = BackEnd::Buffer(); break;
+      case Resource::Type::Texture:     b->textures[pos] = BackEnd::Texture(); break;
+      case Resource::Type::Material:    b->materials[pos] = BackEnd::Material(); break;
+      case Resource::Type::Framebuffer: b->framebuffers[pos] = BackEnd::Framebuffer(); break;
+      default: break;
+      }
+      b->stats.resources_destroyed++;
+    }
+
+  } /* end of gpu namespace */
+
+} /* end of vxr namespace */
+
+#endif
\ No newline at end of file
@@ -0,0 +1,126 @@
+#pragma once
+
+// ----------------------------------------------------------------------------------------
+// MIT License
+// 
+// Copyright(c) 2018 Vctor vila
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ----------------------------------------------------------------------------------------
+
+#include "../../../../include/engine/engine.h"
+
+#ifdef VXR_NULL
+
+#include "../../../../include/graphics/display_list.h"
+
+/**
+* \file null_backend.h
+*
+* \author Victor Avila (avilapa.github.io)
+*
+* \brief Null rendering backend. Nothing is drawn, commands are only recorded (counts, bytes and 
+* state transitions) so that the engine can run headless and the CPU side of rendering can be 
+* profiled in isolation.
+*
+*/
+namespace vxr
+{
+
+  namespace gpu
+  {
+
+    struct BackEnd : public Object
+    {
+
+      VXR_OBJECT(BackEnd, Object);
+
+      struct Buffer
+      {
+        uint32 size = 0;
+      };
+
+      struct Texture
+      {
+        bool initialized = false;
+      };
+
+      struct Material
+      {
+        bool initialized = false;
+      };
+
+      struct Framebuffer 
+      {
+
+      };
+
+      paged_array<Buffer>      buffers;
+      paged_array<Texture>     textures;
+      paged_array<Material>    materials;
+      paged_array<Framebuffer> framebuffers;
+
+      struct Stats
+      {
+        uint32 clears = 0;
+        uint32 setup_views = 0;
+        uint32 framebuffer_changes = 0;
+        uint32 fill_buffers = 0;
+        uint32 buffer_reallocations = 0;
+        uint64 fill_buffer_bytes = 0;
+        uint32 fill_textures = 0;
+        uint64 fill_texture_bytes = 0;
+        uint32 uploads = 0;
+        uint64 upload_bytes = 0;
+        uint32 setup_materials = 0;
+        uint32 material_changes = 0;
+        uint32 uniform_ranges = 0;
+        uint32 programs_created = 0;
+        uint32 draws = 0;
+        uint64 indices = 0;
+        uint64 instances = 0;
+        uint32 resources_destroyed = 0;
+      } stats;
+
+      uint32 current_framebuffer = 0;
+    };
+
+    void InitBackEnd(BackEnd** back_end, const Params::GPU &params = Params::GPU());
+    void DestroyBackEnd(BackEnd** back_end);
+    // Logs everything recorded by the backend so far. Called by GPU::stop() on the logic thread, once the
+    // render thread has been joined.
+    void LogStats();
+
+    void BeginUploads(RenderContext* ctx, uint32 size);
+    void Upload(RenderContext* ctx, uint32 offset, const void* data, uint32 size);
+
+    void ClearScreen(const DisplayList::ClearData& d);
+    void FillBuffer(DisplayList::FillBufferData& d);
+    void FillTexture(DisplayList::FillTextureData& d);
+    void SetupMaterial(DisplayList::SetupMaterialData& d);
+    void SetupView(DisplayList::SetupViewData& d);
+    void Render(DisplayList::RenderData& d);
+    // Frees the backend objects of a resource, called by the render thread once no frame uses it.
+    void DestroyResource(const Resource& r);
+
+  } /* end of gpu namespace */
+
+} /* end of vxr namespace */
+
+#endif
\ No newline at end of file
@@ -0,0 +1,73 @@
+// ----------------------------------------------------------------------------------------
+// MIT License
+// 
+// Copyright(c) 2018 Vctor vila
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ----------------------------------------------------------------------------------------
+
+#include "null_imgui.h"
+
+#ifdef VXR_NULL
+
+namespace vxr
+{
+
+  bool ui::impl::Init(Window::Data* data)
+  {
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGui::StyleColorsDark();
+
+    // The font atlas still has to be built for ImGui::NewFrame() to work.
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    unsigned char* pixels;
+    int width, height;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+    data->time = 0.0;
+    return true;
+  }
+
+  void ui::impl::Update(Window::Data* data)
+  {
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2((float)data->width, (float)data->height);
+
+    double current_time = window::uptime(data);
+    io.DeltaTime = data->time > 0.0 ? (float)(current_time - data->time) : (float)(1.0f / 60.0f);
+    if (io.DeltaTime <= 0.0f)
+    {
+      io.DeltaTime = 1.0f / 60.0f;
+    }
+    data->time = current_time;
+  }
+
+  void ui::impl::Draw(ImDrawData*)
+  {
+  }
+
+  void ui::impl::Stop(Window::Data*)
+  {
+  }
+
+}
+
+#endif
\ No newline at end of file
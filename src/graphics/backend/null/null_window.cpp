@@ -0,0 +1,83 @@
+// ----------------------------------------------------------------------------------------
+// MIT License
+// 
+// Copyright(c) 2018 Vctor vila
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ----------------------------------------------------------------------------------------
+
+#include "null_window.h"
+
+#ifdef VXR_NULL
+
+namespace vxr
+{
+
+  void window::init(Window::Data* data)
+  {
+    data->exiting = false;
+    data->start_time = std::chrono::steady_clock::now();
+    data->frames = 0;
+    data->max_frames = 0;
+    if (const char* max_frames = getenv("VXR_NULL_FRAMES"))
+    {
+      data->max_frames = (uint32)strtoul(max_frames, nullptr, 10);
+    }
+    VXR_LOG(VXR_DEBUG_LEVEL_INFO, "[INFO]: Running windowless (%s, %ux%u).\n", data->name.c_str(), (uint32)data->width, (uint32)data->height);
+  }
+
+  void window::swap(Window::Data* data)
+  {
+    data->frames++;
+    if (data->max_frames > 0 && data->frames >= data->max_frames)
+    {
+      data->exiting = true;
+    }
+  }
+
+  void window::events(Window::Data*)
+  {
+  }
+
+  void window::stop(Window::Data*)
+  {
+  }
+
+  bool window::is_exiting(Window::Data* data)
+  {
+    return data->exiting;
+  }
+
+  double window::uptime(Window::Data* data)
+  {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - data->start_time).count();
+  }
+
+  void window::forceExit(Window::Data* data)
+  {
+    data->exiting = true;
+  }
+
+  void window::set_title(Window::Data*)
+  {
+  }
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+// ----------------------------------------------------------------------------------------
+// MIT License
+// 
+// Copyright(c) 2018 Vctor vila
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ----------------------------------------------------------------------------------------
+
+#ifdef VXR_NULL
+
+#include "../../../../include/graphics/window.h"
+
+#include <chrono>
+
+/**
+* \file null_window_struct.h
+*
+* \author Victor Avila (avilapa.github.io)
+*
+* \brief Null (windowless) window structure.
+*
+*/
+namespace vxr 
+{
+
+  struct Window::Data 
+  {
+    string name;
+    std::atomic<uint16> width;
+    std::atomic<uint16> height;
+    std::atomic<bool> exiting;
+
+    // Frames presented so far and the amount after which the window closes itself (VXR_NULL_FRAMES 
+    // environment variable, 0 runs until forceExit()).
+    uint32 frames = 0;
+    uint32 max_frames = 0;
+
+    std::chrono::steady_clock::time_point start_time;
+    double time = 0.0;
+  };
+
+} /* end of vxr namespace */
+
+#endif
\ No newline at end of file
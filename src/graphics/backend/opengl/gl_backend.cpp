@@ -67,6 +67,7 @@ namespace vxr
     const int COMMON_FRAG_COUNT = 5;
     string common_vert[COMMON_VERT_COUNT];
     string common_frag[COMMON_FRAG_COUNT];
+    string instanced_preprocessor;
 
     void InitBackEnd(BackEnd** b, const Params::GPU &params)
     {
@@ -80,11 +81,20 @@ namespace vxr
       string shader_preprocessor = 
         "#version "                   + std::to_string(kGLShaderVersion) + "\n"
         "#define MAX_LIGHT_SOURCES "  + std::to_string(kMaxLightSources) + "\n"
+        "#define LIGHT_CLUSTERS_X "   + std::to_string(kLightClustersX) + "\n"
+        "#define LIGHT_CLUSTERS_Y "   + std::to_string(kLightClustersY) + "\n"
+        "#define LIGHT_CLUSTERS_Z "   + std::to_string(kLightClustersZ) + "\n"
+        "#define MAX_LIGHT_CLUSTER_INDICES " + std::to_string(kMaxLightClusterIndices) + "\n"
         "#define MESH_HAS_PRECOMPUTED_TANGENTS " + std::to_string(VXR_MESH_PRECOMPUTE_TANGENTS) + "\n"
         ;
 
       common_vert[0] = shader_preprocessor;
       common_frag[0] = shader_preprocessor;
+      instanced_preprocessor = shader_preprocessor +
+        "#define INSTANCED 1\n"
+        "#define MAX_INSTANCES "          + std::to_string(kMaxInstancesPerDraw) + "\n"
+        "#define MAX_INSTANCE_UNIFORMS "  + std::to_string(sizeof(Shader::UniformData) / sizeof(vec4)) + "\n"
+        ;
 
       common_vert[1] = Shader::Load("common.vert");
       common_frag[1] = Shader::Load("common.frag");
@@ -99,6 +109,10 @@ namespace vxr
 
     void DestroyBackEnd(BackEnd** b)
     {
+      if ((*b)->upload_buffer)
+      {
+        GLCHECK(glDeleteBuffers(1, &(*b)->upload_buffer));
+      }
       delete *b;
       *b = nullptr;
     }
@@ -137,6 +151,30 @@ namespace vxr
       GLCHECK(glClear(mask));
     }
 
+    void BeginUploads(RenderContext* ctx, uint32 size)
+    {
+      BackEnd* b = ctx->back_end_;
+      if (!b->upload_buffer)
+      {
+        GLCHECK(glGenBuffers(1, &b->upload_buffer));
+      }
+
+      if (size > b->upload_buffer_size)
+      {
+        b->upload_buffer_size = size;
+      }
+
+      // Orphaning the storage lets the driver keep the previous frame contents alive while in use.
+      GLCHECK(glBindBuffer(GL_COPY_READ_BUFFER, b->upload_buffer));
+      GLCHECK(glBufferData(GL_COPY_READ_BUFFER, b->upload_buffer_size, nullptr, GL_STREAM_DRAW));
+    }
+
+    void Upload(RenderContext* ctx, uint32 offset, const void* data, uint32 size)
+    {
+      GLCHECK(glBindBuffer(GL_COPY_READ_BUFFER, ctx->back_end_->upload_buffer));
+      GLCHECK(glBufferSubData(GL_COPY_READ_BUFFER, offset, size, data));
+    }
+
     void FillBuffer(DisplayList::FillBufferData& d)
     {
       auto b = RenderContext::GetResource(d.buffer.id, &d.buffer.ctx->buffers_, &d.buffer.ctx->back_end_->buffers);
@@ -150,23 +188,36 @@ namespace vxr
       default: break;
       }
 
+      // Buffers keep their size while fills fit in them (sub-allocated buffers are filled by ranges), 
+      // growing one discards its previous contents.
+      uint32 end = d.offset + d.size;
       if (!id)
       {
         GLCHECK(glGenBuffers(1, &id));
         GLCHECK(glBindBuffer(target, id));
-        GLCHECK(glBufferData(target, d.size, nullptr, Translate(b.first->info.usage_)));
+        b.first->info.size_ = glm::max(b.first->info.size_, end);
+        GLCHECK(glBufferData(target, b.first->info.size_, nullptr, Translate(b.first->info.usage_)));
         b.second->buffer = id;
       }
 
       GLCHECK(glBindBuffer(target, id));
       
-      if (b.first->info.size_ != d.size)
+      if (b.first->info.size_ < end)
       {
-        GLCHECK(glBufferData(target, d.size, nullptr, Translate(b.first->info.usage_)));
-        b.first->info.size_ = d.size;
+        GLCHECK(glBufferData(target, end, nullptr, Translate(b.first->info.usage_)));
+        b.first->info.size_ = end;
       }
 
-	    GLCHECK(glBufferSubData(target, d.offset, d.size, d.data));
+      if (d.transient)
+      {
+        GLCHECK(glBindBuffer(GL_COPY_READ_BUFFER, d.buffer.ctx->back_end_->upload_buffer));
+        GLCHECK(glBindBuffer(GL_COPY_WRITE_BUFFER, id));
+        GLCHECK(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, d.transient_offset, d.offset, d.size));
+      }
+      else
+      {
+        GLCHECK(glBufferSubData(target, d.offset, d.size, d.data));
+      }
 
       if (target == GL_UNIFORM_BUFFER)
       {
@@ -390,15 +441,16 @@ namespace vxr
         {
           for (auto &i : mat.second->texture_uniforms_location) { i = -1; }
 
+          const string& preprocessor = mat.first->info.instanced ? instanced_preprocessor : common_vert[0];
           const char* vert[] = 
           { 
-            common_vert[0].c_str(), // vert preprocessor
+            preprocessor.c_str(),   // vert preprocessor
             common_vert[1].c_str(), // common.vert
             mat.first->vert_shader.c_str() 
           };
           const char* frag[] = 
           { 
-            common_frag[0].c_str(), // frag preprocessor
+            preprocessor.c_str(),   // frag preprocessor
             common_frag[1].c_str(), // common.frag
             common_frag[2].c_str(), // common_brdf.frag
             common_frag[3].c_str(), // common_lighting.frag
@@ -540,12 +592,23 @@ namespace vxr
           if (d.uniform_buffer[i].id)
           {
             auto ubo = RenderContext::GetResource(d.uniform_buffer[i].id, &d.material.ctx->buffers_, &d.material.ctx->back_end_->buffers);
-            GLuint uniformIndex = glGetUniformBlockIndex(mat.second->program, ubo.first->info.name_);
+            const char* block = (d.uniform_block[i]) ? d.uniform_block[i] : ubo.first->info.name_;
+            GLuint uniformIndex = glGetUniformBlockIndex(mat.second->program, block);
             GLCHECK(glUniformBlockBinding(mat.second->program, uniformIndex, ubo.second->buffer));
           }
         }
       }
 
+      // Ranges of a shared buffer change between draws of the same program, so they are always bound.
+      for (auto i = 0; i < kMaxUniformBuffers; ++i)
+      {
+        if (d.uniform_buffer[i].id && d.uniform_buffer_size[i])
+        {
+          auto ubo = RenderContext::GetResource(d.uniform_buffer[i].id, &d.material.ctx->buffers_, &d.material.ctx->back_end_->buffers);
+          GLCHECK(glBindBufferRange(GL_UNIFORM_BUFFER, ubo.second->buffer, ubo.second->buffer, d.uniform_buffer_offset[i], d.uniform_buffer_size[i]));
+        }
+      }
+
       glUniformMatrix4fv(glGetUniformLocation(mat.second->program, Shader::u_model), 1, GL_FALSE, &d.model_matrix[0][0]);
 
       if (d.scissor.z > 0.0f && d.scissor.w > 0.0f)
@@ -766,20 +829,60 @@ namespace vxr
       case RenderMode::Solid:
         glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
         GLCHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buf.second->buffer));
-        GLCHECK(glDrawElementsInstanced(Translate(mat.first->info.primitive), d.count, Translate(d.type), (void*)d.offset, d.instances));
+        GLCHECK(glDrawElementsInstancedBaseVertex(Translate(mat.first->info.primitive), d.count, Translate(d.type), (void*)(uintptr_t)d.offset, d.instances, d.base_vertex));
         break;
       case RenderMode::Wireframe:
         glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
         GLCHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buf.second->buffer));
-        GLCHECK(glDrawElementsInstanced(Translate(mat.first->info.primitive), d.count, Translate(d.type), (void*)d.offset, d.instances));
+        GLCHECK(glDrawElementsInstancedBaseVertex(Translate(mat.first->info.primitive), d.count, Translate(d.type), (void*)(uintptr_t)d.offset, d.instances, d.base_vertex));
         break;
       case RenderMode::SolidWireframe:
         glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
         GLCHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buf.second->buffer));
-        GLCHECK(glDrawElementsInstanced(Translate(mat.first->info.primitive), d.count, Translate(d.type), (void*)d.offset, d.instances));
+        GLCHECK(glDrawElementsInstancedBaseVertex(Translate(mat.first->info.primitive), d.count, Translate(d.type), (void*)(uintptr_t)d.offset, d.instances, d.base_vertex));
         glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
         GLCHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buf.second->buffer));
-        GLCHECK(glDrawElementsInstanced(Translate(mat.first->info.primitive), d.count, Translate(d.type), (void*)d.offset, d.instances));
+        GLCHECK(glDrawElementsInstancedBaseVertex(Translate(mat.first->info.primitive), d.count, Translate(d.type), (void*)(uintptr_t)d.offset, d.instances, d.base_vertex));
+        break;
+      }
+    }
+
+    void DestroyResource(const Resource& r)
+    {
+      BackEnd* b = r.ctx->back_end_;
+      uint32 pos = RenderContext::index(r.id);
+      switch (r.type)
+      {
+      case Resource::Type::Buffer:
+        if (b->buffers[pos].buffer)
+        {
+          GLCHECK(glDeleteBuffers(1, &b->buffers[pos].buffer));
+        }
+        b->buffers[pos] = BackEnd::Buffer();
+        break;
+      case Resource::Type::Texture:
+        if (b->textures[pos].texture)
+        {
+          GLCHECK(glDeleteTextures(1, &b->textures[pos].texture));
+        }
+        b->textures[pos] = BackEnd::Texture();
+        r.ctx->textures_[pos].id = 0;
+        break;
+      case Resource::Type::Material:
+        if (b->materials[pos].program)
+        {
+          GLCHECK(glDeleteProgram(b->materials[pos].program));
+        }
+        b->materials[pos] = BackEnd::Material();
+        break;
+      case Resource::Type::Framebuffer:
+        if (b->framebuffers[pos].framebuffer)
+        {
+          GLCHECK(glDeleteFramebuffers(1, &b->framebuffers[pos].framebuffer));
+        }
+        b->framebuffers[pos] = BackEnd::Framebuffer();
+        break;
+      default:
         break;
       }
     }
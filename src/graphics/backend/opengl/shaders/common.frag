@@ -30,7 +30,9 @@
 // Precomputed defines
 //--------------------------------------------------------------------------------
 //
-// MAX_LIGHT_SOURCES					kMaxLightSources (default: 30)
+// MAX_LIGHT_SOURCES					kMaxLightSources (default: 256)
+// LIGHT_CLUSTERS_X/Y/Z				kLightClustersX/Y/Z (default: 16/8/16)
+// MAX_LIGHT_CLUSTER_INDICES			kMaxLightClusterIndices (default: 16384)
 // MESH_HAS_PRECOMPUTED_TANGENTS		VXR_MESH_PRECOMPUTE_TANGENTS (default: 1)
 //
 // --------------------------------------------------------------------------------
@@ -261,12 +263,32 @@ uniform samplerCube u_texCube15;
 
 // Common
 
+#if INSTANCED
+struct InstanceData
+{
+  mat4 model;
+  vec4 uniforms[MAX_INSTANCE_UNIFORMS];
+};
+
+layout(std140) uniform Instances
+{
+  InstanceData u_instances[MAX_INSTANCES];
+};
+
+flat in int in_instance;
+
+mat4 getModelMatrix()
+{
+	return u_instances[in_instance].model;
+}
+#else
 uniform mat4 u_model;
 
 mat4 getModelMatrix()
 {
 	return u_model;
 }
+#endif
 
 layout(std140) uniform Common
 {
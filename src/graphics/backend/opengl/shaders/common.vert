@@ -71,12 +71,33 @@ out vec3 in_bitangent;
 
 // Common
 
+#if INSTANCED
+struct InstanceData
+{
+  mat4 model;
+  vec4 uniforms[MAX_INSTANCE_UNIFORMS];
+};
+
+layout(std140) uniform Instances
+{
+  InstanceData u_instances[MAX_INSTANCES];
+};
+
+// Written by the main() wrapper of instanced materials (see Shader::Instanced).
+flat out int in_instance;
+
+mat4 getModelMatrix()
+{
+	return u_instances[gl_InstanceID].model;
+}
+#else
 uniform mat4 u_model;
 
 mat4 getModelMatrix()
 {
 	return u_model;
 }
+#endif
 
 layout(std140) uniform Common
 {
@@ -125,14 +146,18 @@ float getTime()
 // Helper Functions
 //--------------------------------------------------------------------------------
 
+// Depth pre-pass programs and the materials drawn after them (with an Equal depth test) must compute
+// exactly the same depth.
+invariant gl_Position;
+
 vec4 getClipPosition()
 {
-	return u_proj * u_view * u_model * vec4(attr_position, 1.0);
+	return u_proj * u_view * getModelMatrix() * vec4(attr_position, 1.0);
 }
 
 void setupWorldPositionOutput()
 {
-	in_world_position = vec3(u_model * vec4(attr_position, 1.0));;
+	in_world_position = vec3(getModelMatrix() * vec4(attr_position, 1.0));;
 }
 
 void setupWorldPositionOutput(vec3 position_output)
@@ -142,7 +167,7 @@ void setupWorldPositionOutput(vec3 position_output)
 
 void setupWorldNormalOutput()
 {
-	in_world_normal = mat3(transpose(inverse(u_model))) * attr_normal;
+	in_world_normal = mat3(transpose(inverse(getModelMatrix()))) * attr_normal;
 }
 
 void setupWorldNormalOutput(vec3 normal_output)
@@ -184,7 +209,7 @@ void setupUVOutput(vec2 uv_output)
 void setupTangentBitangentOutput()
 {
 #if MESH_HAS_PRECOMPUTED_TANGENTS
-  	in_tangent = mat3(transpose(inverse(u_model))) * attr_tangent.xyz;
+  	in_tangent = mat3(transpose(inverse(getModelMatrix()))) * attr_tangent.xyz;
   	in_bitangent = cross(in_world_normal, in_tangent) * sign(attr_tangent.w);
 #endif
 }
@@ -33,8 +33,43 @@ layout(std140) uniform Lights
   vec4 direction_ambient[MAX_LIGHT_SOURCES];
 } u_light;
 
+// Lights of the view space clusters (froxels), see LightClusters. Directional lights are listed first in
+// u_light_indices and evaluated everywhere, punctual lights only in the clusters they reach.
+layout(std140) uniform LightClusters
+{
+  vec4 params; // x, y: log(view depth) to slice scale and bias, z: number of directional lights
+  uvec4 cells[(LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y * LIGHT_CLUSTERS_Z) / 4]; // offset << 16 | count
+} u_light_clusters;
+
+layout(std140) uniform LightIndices
+{
+  uvec4 indices[MAX_LIGHT_CLUSTER_INDICES / 16]; // 8 bit light indices
+} u_light_indices;
+
 const float cone_angle = 50.0;
 
+int getNumDirectionalLights()
+{
+  return int(u_light_clusters.params.z);
+}
+
+uint getLightCluster()
+{
+  vec4 view_position = getViewMatrix() * vec4(getWorldPosition(), 1.0);
+  vec4 clip_position = getProjectionMatrix() * view_position;
+  vec2 ndc = clip_position.xy / clip_position.w;
+  ivec2 tile = clamp(ivec2((ndc * 0.5 + 0.5) * vec2(LIGHT_CLUSTERS_X, LIGHT_CLUSTERS_Y)), ivec2(0), ivec2(LIGHT_CLUSTERS_X - 1, LIGHT_CLUSTERS_Y - 1));
+  int slice = clamp(int(floor(log(max(-view_position.z, 1e-4)) * u_light_clusters.params.x + u_light_clusters.params.y)), 0, LIGHT_CLUSTERS_Z - 1);
+  uint cluster = uint((slice * LIGHT_CLUSTERS_Y + tile.y) * LIGHT_CLUSTERS_X + tile.x);
+  return u_light_clusters.cells[cluster >> 2u][cluster & 3u];
+}
+
+int getClusterLightIndex(uint index)
+{
+  uint word = u_light_indices.indices[index >> 4u][(index >> 2u) & 3u];
+  return int((word >> ((index & 3u) * 8u)) & 0xFFu);
+}
+
 vec3 getLightPosition(int index)
 {
 	return u_light.position_falloff[index].xyz;
@@ -169,9 +204,14 @@ vec3 evaluateLights(const MaterialInput material, const PixelParameters pixel, c
 {
   vec3 color = vec3(0.0);
 
-  for (int i = 0; i < getNumLights(); i++)
+  int num_directional = getNumDirectionalLights();
+  uint cell = getLightCluster();
+  uint offset = cell >> 16u;
+  int count = int(cell & 0xFFFFu);
+
+  for (int i = 0; i < num_directional + count; i++)
   {
-    Light light = getLight(i);
+    Light light = getLight(getClusterLightIndex((i < num_directional) ? uint(i) : offset + uint(i - num_directional)));
 
     float visibility = 1.0;
     /// Calculate shadows
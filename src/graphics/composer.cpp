@@ -132,19 +132,38 @@ namespace vxr
       return;
     }
 
-    DisplayList frame;
-    frame.clearCommand()
-      .set_color(Color::Blue)
-      .set_clear_color(true)
-      .set_clear_depth(true);
-    frame.setupMaterialCommand()
+    DisplayList::SetupMaterialData material;
+    material
       .set_material(shared_render_pass->material())
       .set_buffer(0, Engine::ref().assetManager()->default_quad()->vertexBuffer())
       .set_v_texture(shared_render_pass->textureInput());
-    frame.renderCommand()
+    DisplayList::RenderData render;
+    render
       .set_index_buffer(Engine::ref().assetManager()->default_quad()->indexBuffer())
       .set_count(Engine::ref().assetManager()->default_quad()->indexCount())
+      .set_offset(Engine::ref().assetManager()->default_quad()->indexOffset())
+      .set_base_vertex(Engine::ref().assetManager()->default_quad()->baseVertex())
       .set_type(Engine::ref().assetManager()->default_quad()->indexFormat());
+
+    // Only recorded again when the screen texture or the quad change (e.g. on resize).
+    uint64 key = RetainedDisplayList::Key(material, render);
+    if (!render_to_screen_commands_.valid() || render_to_screen_commands_.key() != key)
+    {
+      DisplayList& commands = render_to_screen_commands_.record(key);
+      commands.clearCommand()
+        .set_color(Color::Blue)
+        .set_clear_color(true)
+        .set_clear_depth(true);
+      commands.setupMaterialCommand() = material;
+      commands.renderCommand() = render;
+      if (!render_to_screen_commands_.finish())
+      {
+        return;
+      }
+    }
+
+    DisplayList frame;
+    frame.retainedCommand(render_to_screen_commands_);
     Engine::ref().submitDisplayList(std::move(frame));
   }
 
@@ -195,10 +214,14 @@ namespace vxr
         .set_v_texture(shared_render_pass->textureInput())
         .set_uniform_buffer(0, Engine::ref().camera()->common_uniforms_buffer())
         .set_uniform_buffer(1, Engine::ref().light()->light_uniforms_buffer())
+        .set_uniform_buffer(3, Engine::ref().light()->light_clusters_buffer())
+        .set_uniform_buffer(4, Engine::ref().light()->light_indices_buffer())
         .set_uniform_buffer(2, ((shared_render_pass->uniforms_enabled()) ? shared_render_pass->uniformBuffer() : gpu::Buffer{}));
       frame.renderCommand()
         .set_index_buffer(Engine::ref().assetManager()->default_quad()->indexBuffer())
         .set_count(Engine::ref().assetManager()->default_quad()->indexCount())
+        .set_offset(Engine::ref().assetManager()->default_quad()->indexOffset())
+        .set_base_vertex(Engine::ref().assetManager()->default_quad()->baseVertex())
         .set_type(Engine::ref().assetManager()->default_quad()->indexFormat());
 
       last_output_texture = i->output_texture(0);
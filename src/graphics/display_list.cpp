@@ -25,6 +25,7 @@
 #include "../../include/graphics/display_list.h"
 #include "../../include/graphics/dl_command.h"
 #include "../../include/graphics/render_context.h"
+#include "../../include/graphics/retained_display_list.h"
 #include "../../include/engine/engine.h"
 
 #include <chrono>
@@ -39,68 +40,342 @@ namespace vxr
 
   DisplayList::~DisplayList()
   {
+    ReleasePages(&pages_);
+    ReleasePages(&upload_pages_);
+  }
+
+  std::vector<scoped_ptr<DisplayList::Page>>& DisplayList::PooledPages()
+  {
+    static thread_local std::vector<scoped_ptr<Page>> pages;
+    return pages;
+  }
 
+  scoped_ptr<DisplayList::Page> DisplayList::AcquirePage()
+  {
+    std::vector<scoped_ptr<Page>>& pool = PooledPages();
+    scoped_ptr<Page> page;
+    if (pool.empty())
+    {
+      page.alloc();
+      return page;
+    }
+    page = std::move(pool.back());
+    pool.pop_back();
+    return page;
   }
 
-  void DisplayList::update()
+  void DisplayList::ReleasePages(std::vector<scoped_ptr<Page>>* pages)
+  {
+    std::vector<scoped_ptr<Page>>& pool = PooledPages();
+    for (scoped_ptr<Page>& page : *pages)
+    {
+      if (pool.size() >= kMaxPooledPages)
+      {
+        break;
+      }
+      page->used = 0;
+      pool.push_back(std::move(page));
+    }
+    pages->clear();
+  }
+
+  void DisplayList::update(FrameStats* stats)
   {
     VXR_TRACE_SCOPE("VXR", "Display List Update");
-    VXR_LOG(VXR_DEBUG_LEVEL_DEBUG, "[DEBUG]: Executing Display List (Commands %u)\n", commands_.size());
-    for (uint32 i = 0; i < commands_.size(); i++) {
-      commands_[i].get()->execute();
+    VXR_LOG(VXR_DEBUG_LEVEL_DEBUG, "[DEBUG]: Executing Display List (Commands %u)\n", num_commands_);
+    uint32 transient_bytes = flushUploads();
+    if (stats)
+    {
+      stats->transient_bytes += transient_bytes;
     }
-    commands_.clear();
+    execute(stats);
+    reset();
     /// DEBUG: Perform a wait for test purposes.
     //std::this_thread::sleep_for(std::chrono::milliseconds(16)); 
     VXR_LOG(VXR_DEBUG_LEVEL_DEBUG, "[DEBUG]: Display List Execution Succsessful.\n");
   }
 
+  void DisplayList::CountCommand(Command* c, FrameStats* stats)
+  {
+    switch (c->type)
+    {
+    case DisplayList::Command::SetupView:     stats->setup_views++; break;
+    case DisplayList::Command::Clear:         stats->clears++; break;
+    case DisplayList::Command::SetupMaterial: stats->setup_materials++; break;
+    case DisplayList::Command::Render:        stats->renders++; break;
+    case DisplayList::Command::FillBuffer:
+    {
+      stats->fill_buffers++;
+      stats->fill_buffer_bytes += ((DisplayList::FillBufferData*)c->payload())->size;
+      break;
+    }
+    case DisplayList::Command::FillTexture:
+    {
+      const DisplayList::FillTextureData& d = *(DisplayList::FillTextureData*)c->payload();
+      stats->fill_textures++;
+      if (d.texture.ctx && RenderContext::CheckValidResource(d.texture.id, &d.texture.ctx->textures_))
+      {
+        const void* faces[] = { d.data, d.data_1, d.data_2, d.data_3, d.data_4, d.data_5 };
+        uint64 face_size = (uint64)d.width * d.height * d.depth * d.texture.ctx->textures_[RenderContext::index(d.texture.id)].bytes_per_pixel;
+        for (uint32 i = 0; i < 6; ++i)
+        {
+          stats->fill_texture_bytes += (faces[i]) ? face_size : 0;
+        }
+      }
+      break;
+    }
+    case DisplayList::Command::Retained:
+    {
+      stats->retained_lists++;
+      stats->retained_commands += ((DisplayList::RetainedData*)c->payload())->commands->num_commands();
+      break;
+    }
+    default:
+      break;
+    }
+  }
+
+  void DisplayList::execute(FrameStats* stats) const
+  {
+    for (uint32 p = 0; p < num_pages_used_; ++p) 
+    {
+      const Page* page = pages_[p].get();
+      uint32 offset = 0;
+      while (offset < page->used)
+      {
+        Command* c = (Command*)(page->data + offset);
+        c->execute();
+        if (stats)
+        {
+          CountCommand(c, stats);
+        }
+        offset += c->size;
+      }
+    }
+  }
+
+  void DisplayList::reset()
+  {
+    // Pages are kept around, so that following frames do not allocate memory.
+    for (uint32 p = 0; p < num_pages_used_; ++p)
+    {
+      pages_[p]->used = 0;
+    }
+    num_pages_used_ = 0;
+    num_commands_ = 0;
+
+    for (uint32 p = 0; p < num_upload_pages_used_; ++p)
+    {
+      upload_pages_[p]->used = 0;
+    }
+    num_upload_pages_used_ = 0;
+    if (upload_pages_.size() > kMaxUploadPages)
+    {
+      upload_pages_.erase(upload_pages_.begin() + kMaxUploadPages, upload_pages_.end());
+    }
+
+    retained_.clear();
+  }
+
+  bool DisplayList::empty() const
+  {
+    return num_commands_ == 0;
+  }
+
+  uint32 DisplayList::num_commands() const
+  {
+    return num_commands_;
+  }
+
+  void* DisplayList::allocate(uint32 size)
+  {
+    if (num_pages_used_ == 0 || pages_[num_pages_used_ - 1]->used + size > kPageSize)
+    {
+      if (num_pages_used_ == pages_.size())
+      {
+        pages_.push_back(AcquirePage());
+      }
+      num_pages_used_++;
+    }
+
+    Page* page = pages_[num_pages_used_ - 1].get();
+    void* result = page->data + page->used;
+    page->used += size;
+    num_commands_++;
+    return result;
+  }
+
+  template<class T> T& DisplayList::push(uint16 type)
+  {
+    // Payloads must not own any resource, their destructors are never called.
+    static_assert(alignof(T) <= Command::kAlignment, "Display list command payload is over-aligned.");
+
+    uint32 size = (Command::HeaderSize() + sizeof(T) + Command::kAlignment - 1) & ~(Command::kAlignment - 1);
+    static_assert(sizeof(T) + 2 * Command::kAlignment <= kPageSize, "Display list command does not fit in a page.");
+
+    Command* c = (Command*)allocate(size);
+    c->type = type;
+    c->reserved = 0;
+    c->size = size;
+    return *new (c->payload()) T();
+  }
+
+  void DisplayList::swap(DisplayList& other)
+  {
+    pages_.swap(other.pages_);
+    std::swap(num_pages_used_, other.num_pages_used_);
+    std::swap(num_commands_, other.num_commands_);
+    upload_pages_.swap(other.upload_pages_);
+    std::swap(num_upload_pages_used_, other.num_upload_pages_used_);
+    std::swap(upload_ctx_, other.upload_ctx_);
+    retained_.swap(other.retained_);
+  }
+
+  bool DisplayList::upload(FillBufferData* d)
+  {
+    // Every payload is copied whatever its size, unless the caller guarantees it outlives the frame.
+    const uint32 size = (d->size + Command::kAlignment - 1) & ~(Command::kAlignment - 1);
+    if (!d->data || !d->buffer.ctx || d->size == 0 || d->persistent)
+    {
+      d->transient = false;
+      return false;
+    }
+
+    if (size > kPageSize)
+    {
+      return uploadPages(d);
+    }
+
+    if (num_upload_pages_used_ == 0 || upload_pages_[num_upload_pages_used_ - 1]->used + size > kPageSize)
+    {
+      nextUploadPage();
+    }
+
+    Page* page = upload_pages_[num_upload_pages_used_ - 1].get();
+    memcpy(page->data + page->used, d->data, d->size);
+    d->data = page->data + page->used;
+    d->transient = true;
+    d->transient_offset = (num_upload_pages_used_ - 1) * kPageSize + page->used;
+    page->used += size;
+    upload_ctx_ = d->buffer.ctx;
+    return true;
+  }
+
+  bool DisplayList::uploadPages(FillBufferData* d)
+  {
+    // Pages are uploaded at kPageSize strides, so a payload copied to consecutive full pages stays 
+    // contiguous in the upload buffer. Its source pointer is left untouched, as it can not be 
+    // referenced from a single page.
+    const uint32 first_page = num_upload_pages_used_;
+    const uint8* src = (const uint8*)d->data;
+    uint32 remaining = d->size;
+    while (remaining > 0)
+    {
+      Page* page = nextUploadPage();
+      uint32 chunk = (remaining < kPageSize) ? remaining : kPageSize;
+      memcpy(page->data, src, chunk);
+      page->used = (chunk == kPageSize) ? kPageSize : ((chunk + Command::kAlignment - 1) & ~(Command::kAlignment - 1));
+      src += chunk;
+      remaining -= chunk;
+    }
+
+    d->transient = true;
+    d->transient_offset = first_page * kPageSize;
+    upload_ctx_ = d->buffer.ctx;
+    return true;
+  }
+
+  DisplayList::Page* DisplayList::nextUploadPage()
+  {
+    if (num_upload_pages_used_ == upload_pages_.size())
+    {
+      upload_pages_.push_back(AcquirePage());
+    }
+    Page* page = upload_pages_[num_upload_pages_used_++].get();
+    page->used = 0;
+    return page;
+  }
+
+  uint32 DisplayList::flushUploads()
+  {
+    if (num_upload_pages_used_ == 0)
+    {
+      return 0;
+    }
+
+    VXR_TRACE_SCOPE("VXR", "Flush Uploads");
+    // Pages are laid out at kPageSize strides, matching the offsets given to the commands.
+    uint32 total_size = (num_upload_pages_used_ - 1) * kPageSize + upload_pages_[num_upload_pages_used_ - 1]->used;
+    Command::BeginUploads(upload_ctx_, total_size);
+    for (uint32 p = 0; p < num_upload_pages_used_; ++p)
+    {
+      Command::Upload(upload_ctx_, p * kPageSize, upload_pages_[p]->data, upload_pages_[p]->used);
+    }
+    return total_size;
+  }
+
+  void DisplayList::append(DisplayList& other)
+  {
+    for (uint32 p = 0; p < other.num_pages_used_; ++p)
+    {
+      Page* page = other.pages_[p].get();
+      uint32 offset = 0;
+      while (offset < page->used)
+      {
+        Command* c = (Command*)(page->data + offset);
+        Command* copy = (Command*)allocate(c->size);
+        memcpy(copy, c, c->size);
+        if (copy->type == Command::FillBuffer)
+        {
+          upload((FillBufferData*)copy->payload());
+        }
+        offset += c->size;
+      }
+    }
+    retained_.insert(retained_.end(), other.retained_.begin(), other.retained_.end());
+    other.reset();
+  }
+
   DisplayList::SetupViewData& DisplayList::setupViewCommand()
   {
-    scoped_ptr<Command> c;
-    SetupViewCommand* cmd = c.allocT<SetupViewCommand>();
-    commands_.push_back(std::move(c));
-    return cmd->data_;
+    return push<SetupViewData>(Command::SetupView);
   }
 
   DisplayList::ClearData& DisplayList::clearCommand()
   {
-    scoped_ptr<Command> c;
-    ClearCommand* cmd = c.allocT<ClearCommand>();
-    commands_.push_back(std::move(c));
-    return cmd->data_;
+    return push<ClearData>(Command::Clear);
   }
 
   DisplayList::FillBufferData& DisplayList::fillBufferCommand()
   {
-    scoped_ptr<Command> c;
-    FillBufferCommand* cmd = c.allocT<FillBufferCommand>();
-    commands_.push_back(std::move(c));
-    return cmd->data_;
+    return push<FillBufferData>(Command::FillBuffer);
   }
 
   DisplayList::FillTextureData& DisplayList::fillTextureCommand()
   {
-    scoped_ptr<Command> c;
-    FillTextureCommand* cmd = c.allocT<FillTextureCommand>();
-    commands_.push_back(std::move(c));
-    return cmd->data_;
+    return push<FillTextureData>(Command::FillTexture);
   }
 
   DisplayList::SetupMaterialData& DisplayList::setupMaterialCommand()
   {
-    scoped_ptr<Command> c;
-    SetupMaterialCommand* cmd = c.allocT<SetupMaterialCommand>();
-    commands_.push_back(std::move(c));
-    return cmd->data_;
+    return push<SetupMaterialData>(Command::SetupMaterial);
   }
 
   DisplayList::RenderData& DisplayList::renderCommand()
   {
-    scoped_ptr<Command> c;
-    RenderCommand* cmd = c.allocT<RenderCommand>();
-    commands_.push_back(std::move(c));
-    return cmd->data_;
+    return push<RenderData>(Command::Render);
+  }
+
+  bool DisplayList::retainedCommand(const RetainedDisplayList& retained)
+  {
+    if (!retained.valid())
+    {
+      return false;
+    }
+
+    retained_.push_back(retained.commands_);
+    push<RetainedData>(Command::Retained).commands = retained.commands_.get();
+    return true;
   }
 
 }
\ No newline at end of file
@@ -30,53 +30,88 @@
 #  include "../graphics/backend/opengl/gl_backend.h"
 #elif defined (VXR_DX11)
 #  include "../graphics/backend/dx11/dx11_backend.h"
+#elif defined (VXR_NULL)
+#  include "../graphics/backend/null/null_backend.h"
 #else
-#  error Backend must be defined on GENie.lua (e.g. try parameters --gl OR --dx11).
+#  error Backend must be defined on GENie.lua (e.g. try parameters --gl, --dx11 OR --null).
 #endif
 
 namespace vxr
 {
-  DisplayList::Command::Command()
-  {
-  }
-
-  DisplayList::Command::~Command()
-  {
-  }
-
-  void SetupViewCommand::execute()
-  {
-    VXR_TRACE_SCOPE("VXR", "Setup View");
-    gpu::SetupView(data_);
-  }
-
-  void ClearCommand::execute()
-  {
-    VXR_TRACE_SCOPE("VXR", "Clear");
-    gpu::ClearScreen(data_);
-  }
-
-  void FillBufferCommand::execute()
-  {
-    VXR_TRACE_SCOPE("VXR", "Fill Buffer");
-    gpu::FillBuffer(data_);
-  }
 
-  void FillTextureCommand::execute()
+  void DisplayList::Command::BeginUploads(RenderContext* ctx, uint32 size)
   {
-    VXR_TRACE_SCOPE("VXR", "Fill Texture");
-    gpu::FillTexture(data_);
+    gpu::BeginUploads(ctx, size);
   }
 
-  void SetupMaterialCommand::execute()
+  void DisplayList::Command::Upload(RenderContext* ctx, uint32 offset, const void* data, uint32 size)
   {
-    VXR_TRACE_SCOPE("VXR", "Setup Material");
-    gpu::SetupMaterial(data_);
+    VXR_TRACE_SCOPE("VXR", "Upload");
+    gpu::Upload(ctx, offset, data, size);
   }
 
-  void RenderCommand::execute()
+  void DisplayList::Command::execute()
   {
-    VXR_TRACE_SCOPE("VXR", "Render");
-    gpu::Render(data_);
+    switch (type)
+    {
+    case SetupView:
+    {
+      VXR_TRACE_SCOPE("VXR", "Setup View");
+      gpu::SetupView(*(DisplayList::SetupViewData*)payload());
+      break;
+    }
+    case Clear:
+    {
+      VXR_TRACE_SCOPE("VXR", "Clear");
+      gpu::ClearScreen(*(DisplayList::ClearData*)payload());
+      break;
+    }
+    case FillBuffer:
+    {
+      VXR_TRACE_SCOPE("VXR", "Fill Buffer");
+      DisplayList::FillBufferData& d = *(DisplayList::FillBufferData*)payload();
+      gpu::FillBuffer(d);
+      // Backends grow the buffer when the fill does not fit in it, keep track of its memory.
+      if (d.buffer.ctx && RenderContext::CheckValidResource(d.buffer.id, &d.buffer.ctx->buffers_))
+      {
+        gpu::BufferInstance& inst = d.buffer.ctx->buffers_[RenderContext::index(d.buffer.id)];
+        RenderContext::SetInstanceMemory(&inst, inst.info.size_, &d.buffer.ctx->buffer_memory_);
+      }
+      break;
+    }
+    case FillTexture:
+    {
+      VXR_TRACE_SCOPE("VXR", "Fill Texture");
+      DisplayList::FillTextureData& d = *(DisplayList::FillTextureData*)payload();
+      gpu::FillTexture(d);
+      if (d.build_mipmap && d.texture.ctx && RenderContext::CheckValidResource(d.texture.id, &d.texture.ctx->textures_))
+      {
+        gpu::TextureInstance& inst = d.texture.ctx->textures_[RenderContext::index(d.texture.id)];
+        RenderContext::SetInstanceMemory(&inst, RenderContext::TextureMemory(inst, true), &d.texture.ctx->texture_memory_);
+      }
+      break;
+    }
+    case SetupMaterial:
+    {
+      VXR_TRACE_SCOPE("VXR", "Setup Material");
+      gpu::SetupMaterial(*(DisplayList::SetupMaterialData*)payload());
+      break;
+    }
+    case Render:
+    {
+      VXR_TRACE_SCOPE("VXR", "Render");
+      gpu::Render(*(DisplayList::RenderData*)payload());
+      break;
+    }
+    case Retained:
+    {
+      VXR_TRACE_SCOPE("VXR", "Retained");
+      ((DisplayList::RetainedData*)payload())->commands->execute();
+      break;
+    }
+    default:
+      VXR_LOG(VXR_DEBUG_LEVEL_ERROR, "[ERROR]: [GPU] Unknown display list command type (%u).\n", type);
+      break;
+    }
   }
 }
\ No newline at end of file
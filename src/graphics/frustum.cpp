@@ -0,0 +1,210 @@
+// ----------------------------------------------------------------------------------------
+// MIT License
+// 
+// Copyright(c) 2018 Vctor vila
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ----------------------------------------------------------------------------------------
+
+#include "../../include/graphics/frustum.h"
+
+#if VXR_SIMD
+#  include <xmmintrin.h>
+#endif
+
+namespace vxr
+{
+
+  Bounds Bounds::FromPoints(const std::vector<vec3>& points)
+  {
+    Bounds b;
+    if (points.empty())
+    {
+      return b;
+    }
+
+    b.min = points[0];
+    b.max = points[0];
+    for (const vec3& p : points)
+    {
+      b.min = glm::min(b.min, p);
+      b.max = glm::max(b.max, p);
+    }
+
+    // The sphere is centered on the box, its radius reaches the farthest point (tighter than the half diagonal).
+    b.center = (b.min + b.max) * 0.5f;
+    float radius2 = 0.0f;
+    for (const vec3& p : points)
+    {
+      vec3 d = p - b.center;
+      radius2 = glm::max(radius2, glm::dot(d, d));
+    }
+    b.radius = glm::sqrt(radius2);
+    return b;
+  }
+
+  void Bounds::transform(const mat4& transform, vec3* world_center, vec3* world_extents) const
+  {
+    vec3 center = (min + max) * 0.5f;
+    vec3 extents = (max - min) * 0.5f;
+    *world_center = vec3(transform * vec4(center, 1.0f));
+    // Each world axis extent is the sum of the projections of the rotated and scaled local extents.
+    *world_extents = glm::abs(vec3(transform[0])) * extents.x 
+                   + glm::abs(vec3(transform[1])) * extents.y 
+                   + glm::abs(vec3(transform[2])) * extents.z;
+  }
+
+  // -------------------------------------------------------------------------------------------------------
+
+  void Frustum::set(const mat4& m)
+  {
+    vec4 row[4];
+    for (uint32 i = 0; i < 4; ++i)
+    {
+      row[i] = vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+    }
+
+    planes_[0] = row[3] + row[0]; // Left
+    planes_[1] = row[3] - row[0]; // Right
+    planes_[2] = row[3] + row[1]; // Bottom
+    planes_[3] = row[3] - row[1]; // Top
+    planes_[4] = row[3] + row[2]; // Near
+    planes_[5] = row[3] - row[2]; // Far
+
+    for (uint32 i = 0; i < 6; ++i)
+    {
+      float length = glm::length(vec3(planes_[i]));
+      if (length > 0.0f)
+      {
+        planes_[i] /= length;
+      }
+    }
+  }
+
+  bool Frustum::test(const vec3& center, const vec3& extents) const
+  {
+    for (uint32 i = 0; i < 6; ++i)
+    {
+      vec3 n = vec3(planes_[i]);
+      float d = glm::dot(n, center) + planes_[i].w;
+      float r = glm::dot(glm::abs(n), extents);
+      if (d + r < 0.0f)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  const vec4& Frustum::plane(uint32 i) const
+  {
+    return planes_[i];
+  }
+
+  // -------------------------------------------------------------------------------------------------------
+
+  void FrustumCuller::clear()
+  {
+    cx_.clear(); cy_.clear(); cz_.clear();
+    ex_.clear(); ey_.clear(); ez_.clear();
+    count_ = 0;
+  }
+
+  void FrustumCuller::add(const vec3& center, const vec3& extents)
+  {
+    if ((count_ & 3) == 0)
+    {
+      size_t size = count_ + 4;
+      cx_.resize(size, 0.0f); cy_.resize(size, 0.0f); cz_.resize(size, 0.0f);
+      ex_.resize(size, 0.0f); ey_.resize(size, 0.0f); ez_.resize(size, 0.0f);
+    }
+    cx_[count_] = center.x; cy_[count_] = center.y; cz_[count_] = center.z;
+    ex_[count_] = extents.x; ey_[count_] = extents.y; ez_[count_] = extents.z;
+    count_++;
+  }
+
+  void FrustumCuller::cull(const Frustum& frustum, std::vector<uint32>* visible) const
+  {
+#if VXR_SIMD
+    if (simd_)
+    {
+      cullSIMD(frustum, visible);
+      return;
+    }
+#endif
+    for (uint32 i = 0; i < count_; ++i)
+    {
+      if (frustum.test(vec3(cx_[i], cy_[i], cz_[i]), vec3(ex_[i], ey_[i], ez_[i])))
+      {
+        visible->push_back(i);
+      }
+    }
+  }
+
+#if VXR_SIMD
+  void FrustumCuller::cullSIMD(const Frustum& frustum, std::vector<uint32>* visible) const
+  {
+    __m128 n[6][3], an[6][3], w[6];
+    for (uint32 p = 0; p < 6; ++p)
+    {
+      const vec4& plane = frustum.plane(p);
+      for (uint32 a = 0; a < 3; ++a)
+      {
+        n[p][a] = _mm_set1_ps(plane[a]);
+        an[p][a] = _mm_set1_ps(glm::abs(plane[a]));
+      }
+      w[p] = _mm_set1_ps(plane.w);
+    }
+    const __m128 zero = _mm_setzero_ps();
+
+    for (uint32 i = 0; i < count_; i += 4)
+    {
+      __m128 cx = _mm_loadu_ps(&cx_[i]), cy = _mm_loadu_ps(&cy_[i]), cz = _mm_loadu_ps(&cz_[i]);
+      __m128 ex = _mm_loadu_ps(&ex_[i]), ey = _mm_loadu_ps(&ey_[i]), ez = _mm_loadu_ps(&ez_[i]);
+
+      int mask = 0xF;
+      for (uint32 p = 0; p < 6 && mask; ++p)
+      {
+        __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(n[p][0], cx), _mm_mul_ps(n[p][1], cy)), _mm_add_ps(_mm_mul_ps(n[p][2], cz), w[p]));
+        __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(an[p][0], ex), _mm_mul_ps(an[p][1], ey)), _mm_mul_ps(an[p][2], ez));
+        mask &= _mm_movemask_ps(_mm_cmpge_ps(_mm_add_ps(d, r), zero));
+      }
+
+      for (uint32 j = 0; mask; ++j, mask >>= 1)
+      {
+        if ((mask & 1) && i + j < count_)
+        {
+          visible->push_back(i + j);
+        }
+      }
+    }
+  }
+#endif
+
+  uint32 FrustumCuller::size() const
+  {
+    return count_;
+  }
+
+  void FrustumCuller::set_simd(bool enabled)
+  {
+    simd_ = enabled;
+  }
+
+} /* end of vxr namespace */
\ No newline at end of file
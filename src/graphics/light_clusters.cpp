@@ -0,0 +1,190 @@
+// ----------------------------------------------------------------------------------------
+// MIT License
+// 
+// Copyright(c) 2018 Vctor vila
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ----------------------------------------------------------------------------------------
+
+#include "../../include/graphics/light_clusters.h"
+
+#include <string.h>
+
+#if VXR_SIMD
+#  include <xmmintrin.h>
+#endif
+
+namespace vxr
+{
+
+  static_assert(kMaxLightSources <= 256, "Cluster light indices are stored in 8 bits.");
+  static_assert(kLightClustersX % 4 == 0, "Rows of clusters are tested four at a time.");
+  static_assert(kMaxLightClusterIndices <= 0xFFFF, "Cluster offsets are stored in 16 bits.");
+
+  void LightClusters::setup(const mat4& projection, float near_plane, float far_plane)
+  {
+    if (projection == projection_ && near_plane == near_plane_ && far_plane == far_plane_)
+    {
+      return;
+    }
+    projection_ = projection;
+    near_plane_ = near_plane;
+    far_plane_ = far_plane;
+
+    // slice = log(depth / near) / log(far / near) * kLightClustersZ, as scale * log(depth) + bias.
+    const float near_depth = glm::max(near_plane, 1e-3f);
+    const float far_depth = glm::max(far_plane, near_depth * 1.01f);
+    const float log_ratio = glm::log(far_depth / near_depth);
+    depth_scale_ = (float)kLightClustersZ / log_ratio;
+    depth_bias_ = -(float)kLightClustersZ * glm::log(near_depth) / log_ratio;
+
+    // A view space point at depth d projects to ndc (x * p00 / d, y * p11 / d) with a symmetric projection.
+    const float inv_p00 = 1.0f / projection[0][0];
+    const float inv_p11 = 1.0f / projection[1][1];
+    for (uint32 z = 0; z < kLightClustersZ; ++z)
+    {
+      const float zn = near_depth * glm::pow(far_depth / near_depth, (float)z / (float)kLightClustersZ);
+      const float zf = near_depth * glm::pow(far_depth / near_depth, (float)(z + 1) / (float)kLightClustersZ);
+      slice_near_[z] = zn;
+      slice_far_[z] = zf;
+      for (uint32 y = 0; y < kLightClustersY; ++y)
+      {
+        const float y0 = (-1.0f + 2.0f * (float)y / (float)kLightClustersY) * inv_p11;
+        const float y1 = (-1.0f + 2.0f * (float)(y + 1) / (float)kLightClustersY) * inv_p11;
+        for (uint32 x = 0; x < kLightClustersX; ++x)
+        {
+          const float x0 = (-1.0f + 2.0f * (float)x / (float)kLightClustersX) * inv_p00;
+          const float x1 = (-1.0f + 2.0f * (float)(x + 1) / (float)kLightClustersX) * inv_p00;
+          const uint32 c = (z * kLightClustersY + y) * kLightClustersX + x;
+          min_x_[c] = glm::min(x0 * zn, x0 * zf);
+          max_x_[c] = glm::max(x1 * zn, x1 * zf);
+          min_y_[c] = glm::min(y0 * zn, y0 * zf);
+          max_y_[c] = glm::max(y1 * zn, y1 * zf);
+          min_z_[c] = -zf;
+          max_z_[c] = -zn;
+        }
+      }
+    }
+  }
+
+  void LightClusters::begin(const mat4& view, const Shader::LightData& lights, const uint8* slots, uint32 count)
+  {
+    spheres_.resize(count);
+    slots_.assign(slots, slots + count);
+    for (uint32 i = 0; i < count; ++i)
+    {
+      const vec4& position_falloff = lights.position_falloff[slots[i]];
+      const vec3 center = vec3(view * vec4(vec3(position_falloff), 1.0f));
+      spheres_[i] = vec4(center, 1.0f / glm::sqrt(glm::abs(position_falloff.w)));
+    }
+    lights_.resize(kLightClusters * kMaxLightSources);
+  }
+
+  void LightClusters::bin(uint32 slice)
+  {
+    const uint32 first_cluster = slice * kLightClustersX * kLightClustersY;
+    const uint32 num_clusters = kLightClustersX * kLightClustersY;
+    uint16* counts = &counts_[first_cluster];
+    for (uint32 c = 0; c < num_clusters; ++c)
+    {
+      counts[c] = 0;
+    }
+
+    for (uint32 l = 0; l < (uint32)spheres_.size(); ++l)
+    {
+      const vec4& s = spheres_[l];
+      const float depth = -s.z;
+      if (depth + s.w < slice_near_[slice] || depth - s.w > slice_far_[slice])
+      {
+        continue;
+      }
+      const uint8 index = slots_[l];
+#if VXR_SIMD
+      const __m128 cx = _mm_set1_ps(s.x), cy = _mm_set1_ps(s.y), cz = _mm_set1_ps(s.z);
+      const __m128 r2 = _mm_set1_ps(s.w * s.w);
+      const __m128 zero = _mm_setzero_ps();
+      for (uint32 c = 0; c < num_clusters; c += 4)
+      {
+        const uint32 i = first_cluster + c;
+        // Distance from the center to the box along each axis, 0 inside.
+        __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&min_x_[i]), cx), _mm_sub_ps(cx, _mm_loadu_ps(&max_x_[i]))), zero);
+        __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&min_y_[i]), cy), _mm_sub_ps(cy, _mm_loadu_ps(&max_y_[i]))), zero);
+        __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&min_z_[i]), cz), _mm_sub_ps(cz, _mm_loadu_ps(&max_z_[i]))), zero);
+        __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        const int mask = _mm_movemask_ps(_mm_cmple_ps(d2, r2));
+        for (uint32 j = 0; mask && j < 4; ++j)
+        {
+          if (mask & (1 << j))
+          {
+            lights_[(i + j) * kMaxLightSources + counts[c + j]++] = index;
+          }
+        }
+      }
+#else
+      for (uint32 c = 0; c < num_clusters; ++c)
+      {
+        const uint32 i = first_cluster + c;
+        const float dx = glm::max(glm::max(min_x_[i] - s.x, s.x - max_x_[i]), 0.0f);
+        const float dy = glm::max(glm::max(min_y_[i] - s.y, s.y - max_y_[i]), 0.0f);
+        const float dz = glm::max(glm::max(min_z_[i] - s.z, s.z - max_z_[i]), 0.0f);
+        if (dx * dx + dy * dy + dz * dz <= s.w * s.w)
+        {
+          lights_[i * kMaxLightSources + counts[c]++] = index;
+        }
+      }
+#endif
+    }
+  }
+
+  bool LightClusters::compact(const uint8* directional, uint32 num_directional, Shader::LightClusterData* clusters, Shader::LightIndexData* indices)
+  {
+    clusters->params = vec4(depth_scale_, depth_bias_, 0.0f, 0.0f);
+    bool fits = true;
+    if (num_directional)
+    {
+      memcpy(indices->indices, directional, num_directional);
+    }
+    uint32 offset = num_directional;
+    for (uint32 c = 0; c < kLightClusters; ++c)
+    {
+      uint32 count = counts_[c];
+      if (offset + count > kMaxLightClusterIndices)
+      {
+        count = (uint32)kMaxLightClusterIndices - offset;
+        fits = false;
+      }
+      memcpy(&indices->indices[offset], &lights_[c * kMaxLightSources], count);
+      clusters->cells[c] = (offset << 16) | count;
+      offset += count;
+    }
+    num_indices_ = offset;
+    return fits;
+  }
+
+  uint32 LightClusters::num_slices() const
+  {
+    return kLightClustersZ;
+  }
+
+  uint32 LightClusters::num_indices() const
+  {
+    return num_indices_;
+  }
+
+} /* end of vxr namespace */
\ No newline at end of file
@@ -25,7 +25,9 @@
 #include "../../../include/graphics/materials/material.h"
 #include "../../../include/graphics/materials/shader.h"
 #include "../../../include/engine/engine.h"
-#include "../../../include/engine/GPU.h"
+#include "../../../include/engine/gpu.h"
+
+#include <regex>
 
 namespace vxr
 {
@@ -58,6 +60,11 @@ namespace vxr
 
     Material::~Material()
     {
+      Engine::ref().gpu()->destroyMaterial(gpu_.mat);
+      Engine::ref().gpu()->destroyMaterial(gpu_.instanced);
+      Engine::ref().gpu()->destroyMaterial(gpu_.equal);
+      Engine::ref().gpu()->destroyMaterial(gpu_.equal_instanced);
+      Engine::ref().gpu()->destroyBuffer(gpu_.uniform_buffer);
     }
 
     bool Material::setup()
@@ -67,6 +74,34 @@ namespace vxr
         VXR_TRACE_SCOPE("VXR", "Material Setup");
         gpu_.mat = Engine::ref().gpu()->createMaterial(gpu_.info);
 
+        // Transparent materials are drawn back-to-front one by one, they never get instanced.
+        if (use_instancing_ && !gpu_.info.blend.enabled)
+        {
+          gpu::Material::Info info = gpu_.info;
+          if (Shader::Instanced(gpu_.info.shader.vert, gpu_.info.shader.frag, use_uniforms_ ? uniforms_name_ : nullptr, &info.shader.vert, &info.shader.frag))
+          {
+            info.instanced = true;
+            gpu_.instanced = Engine::ref().gpu()->createMaterial(info);
+          }
+        }
+
+        // Only opaque solid materials with the default depth state can rely on the pre-pass depth.
+        const gpu::Material::Info& info = gpu_.info;
+        if (use_depth_prepass_ && !info.blend.enabled && info.render_mode == RenderMode::Solid &&
+            info.depth_func == CompareFunc::Less && info.depth_write && info.rgba_write)
+        {
+          gpu::Material::Info equal_info = info;
+          equal_info.depth_func = CompareFunc::Equal;
+          equal_info.depth_write = false;
+          gpu_.equal = Engine::ref().gpu()->createMaterial(equal_info);
+          if (gpu_.instanced.id)
+          {
+            Shader::Instanced(info.shader.vert, info.shader.frag, use_uniforms_ ? uniforms_name_ : nullptr, &equal_info.shader.vert, &equal_info.shader.frag);
+            equal_info.instanced = true;
+            gpu_.equal_instanced = Engine::ref().gpu()->createMaterial(equal_info);
+          }
+        }
+
         if (use_uniforms_)
         {
           gpu_.uniform_buffer = Engine::ref().gpu()->createBuffer({ BufferType::Uniform, sizeof(Shader::UniformData), uniforms_usage_, uniforms_name_ });
@@ -77,24 +112,25 @@ namespace vxr
       return true;
     }
 
-    bool Material::setupTextureTypes(std::vector<ref_ptr<Texture>> textures)
+    bool Material::setupTextureTypes(const std::vector<ref_ptr<Texture>>& textures)
     {
       for (uint32 i = common_textures_; i < gpu_.tex.size(); ++i)
       {
-        if (!textures[i])
+        ref_ptr<Texture> texture = textures[i];
+        if (!texture)
         {
           return false;
         }
 
-        if (textures[i]->hasChanged())
+        if (texture->hasChanged())
         {
-          if (!textures[i]->setup())
+          if (!texture->setup())
           {
             return false;
           }
         }
-        gpu_.info.textures[i] = textures[i]->gpu_.info.type;
-        gpu_.tex[i] = textures[i]->gpu_.tex;
+        gpu_.info.textures[i] = texture->gpu_.info.type;
+        gpu_.tex[i] = texture->gpu_.tex;
       }
 
       return true;
@@ -120,6 +156,16 @@ namespace vxr
       uniforms_usage_ = usage;
     }
 
+    void Material::set_instancing_enabled(bool enabled)
+    {
+      use_instancing_ = enabled;
+    }
+
+    void Material::set_depth_prepass_enabled(bool enabled)
+    {
+      use_depth_prepass_ = enabled;
+    }
+
     void Material::set_num_textures(uint32 count)
     {
       gpu_.tex.resize(count);
@@ -178,6 +224,21 @@ namespace vxr
       return gpu_.mat;
     }
 
+    gpu::Material Material::instancedMaterial() const
+    {
+      return gpu_.instanced;
+    }
+
+    gpu::Material Material::equalDepthMaterial() const
+    {
+      return gpu_.equal;
+    }
+
+    gpu::Material Material::equalDepthInstancedMaterial() const
+    {
+      return gpu_.equal_instanced;
+    }
+
     gpu::Buffer Material::uniformBuffer() const
     {
       return gpu_.uniform_buffer;
@@ -210,10 +271,20 @@ namespace vxr
         }
       }
 
+      if (gpu_.tex[index].id != texture->gpu_.tex.id)
+      {
+        version_++;
+      }
+
       gpu_.info.textures[index] = texture->gpu_.info.type;
       gpu_.tex[index] = texture->gpu_.tex;
     }
 
+    uint32 Material::version() const
+    {
+      return version_;
+    }
+
   }
 
   string Shader::Load(const char* file)
@@ -222,8 +293,11 @@ namespace vxr
     string path = "../../src/graphics/backend/opengl/shaders/";
 #elif defined (VXR_DX11)
     string path = "";
+#elif defined (VXR_NULL)
+    // Shaders are never compiled, but materials still load their sources.
+    string path = "../../src/graphics/backend/opengl/shaders/";
 #else
-#  error Backend must be defined on GENie.lua (e.g. --gl OR --dx11).
+#  error Backend must be defined on GENie.lua (e.g. --gl, --dx11 OR --null).
 #endif
     string content;
     std::ifstream file_stream(file, std::ios::in);
@@ -248,4 +322,59 @@ namespace vxr
     return content;
   }
 
+  bool Shader::Instanced(const string& vert, const string& frag, const char* block, string* instanced_vert, string* instanced_frag)
+  {
+    // The material main() is renamed and called from a new one that sets up the instance first.
+    static const string kMain = "vxr_instanced_main";
+
+    *instanced_vert = "#define main " + kMain + "\n" + vert +
+      "\n#undef main\n"
+      "void main()\n"
+      "{\n"
+      "  in_instance = gl_InstanceID;\n"
+      "  " + kMain + "();\n"
+      "}\n";
+
+    if (!block)
+    {
+      *instanced_frag = frag;
+      return true;
+    }
+
+    std::smatch match;
+    std::regex block_regex("(layout\\s*\\(\\s*std140\\s*\\)\\s*)?uniform\\s+" + string(block) + "\\s*\\{([^}]*)\\}\\s*;");
+    if (!std::regex_search(frag, match, block_regex))
+    {
+      return false;
+    }
+
+    std::regex member_regex("\\s*vec4\\s+(\\w+)\\s*");
+    std::stringstream members(match[2].str());
+    string member, globals, setup;
+    uint32 count = 0;
+    while (std::getline(members, member, ';'))
+    {
+      if (member.find_first_not_of(" \t\r\n") == string::npos)
+      {
+        continue;
+      }
+      std::smatch member_match;
+      if (!std::regex_match(member, member_match, member_regex) || count >= sizeof(UniformData) / sizeof(vec4))
+      {
+        return false;
+      }
+      globals += "vec4 " + member_match[1].str() + ";\n";
+      setup += "  " + member_match[1].str() + " = u_instances[in_instance].uniforms[" + std::to_string(count++) + "];\n";
+    }
+
+    *instanced_frag = "#define main " + kMain + "\n" + match.prefix().str() + globals + match.suffix().str() +
+      "\n#undef main\n"
+      "void main()\n"
+      "{\n" +
+      setup +
+      "  " + kMain + "();\n"
+      "}\n";
+    return true;
+  }
+
 }
\ No newline at end of file
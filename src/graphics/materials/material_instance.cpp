@@ -68,6 +68,7 @@ namespace vxr
       }
 
       textures_[i].resize(shared_materials_[i]->num_textures());
+      version_++;
     }
 
     void MaterialInstance::init(std::initializer_list<string> shared_material_names)
@@ -82,6 +83,7 @@ namespace vxr
     void MaterialInstance::set_active_material(uint32 index)
     {
       active_material_ = index;
+      version_++;
     }
 
     uint32 MaterialInstance::active_material() const
@@ -97,6 +99,7 @@ namespace vxr
     void MaterialInstance::set_texture(uint32 index, ref_ptr<Texture> texture)
     {
       textures_[active_material_][index] = texture;
+      version_++;
     }
 
     ref_ptr<Texture> MaterialInstance::texture(uint32 index /* = 0 */) const
@@ -104,11 +107,16 @@ namespace vxr
       return textures_[active_material_][index];
     }
 
-    std::vector<ref_ptr<Texture>> MaterialInstance::textures() const
+    const std::vector<ref_ptr<Texture>>& MaterialInstance::textures() const
     {
       return textures_[active_material_];
     }
 
+    uint32 MaterialInstance::version() const
+    {
+      return version_;
+    }
+
   }
 
 }
\ No newline at end of file
@@ -25,7 +25,7 @@
 #include "../../../include/graphics/materials/render_pass.h"
 #include "../../../include/graphics/materials/shader.h"
 #include "../../../include/engine/engine.h"
-#include "../../../include/engine/GPU.h"
+#include "../../../include/engine/gpu.h"
 
 namespace vxr
 {
@@ -56,6 +56,9 @@ namespace vxr
 
     RenderPass::~RenderPass()
     {
+      Engine::ref().gpu()->destroyMaterial(gpu_.mat);
+      Engine::ref().gpu()->destroyBuffer(gpu_.uniform_buffer);
+      Engine::ref().gpu()->destroyFramebuffer(gpu_.fbo);
     }
 
     bool RenderPass::setup()
@@ -44,7 +44,10 @@ namespace vxr
 
   Mesh::~Mesh()
   {
-
+    Engine::ref().gpu()->meshArena()->freeVertices(&gpu_.vertex.range);
+    Engine::ref().gpu()->meshArena()->freeIndices(&gpu_.index.range);
+    Engine::ref().gpu()->releaseData(std::move(gpu_.vertex.data));
+    Engine::ref().gpu()->releaseData(std::move(gpu_.index.data));
   }
 
   void Mesh::onGUI()
@@ -102,50 +105,45 @@ namespace vxr
     }
 #endif
 
-	  gpu_.vertex.data.clear();
-    gpu_.index.data.clear();
+    bounds_ = Bounds::FromPoints(vertices_);
+
+    // Frames in flight may still be uploading the previous geometry, it is never modified in place.
+    Engine::ref().gpu()->releaseData(std::move(gpu_.vertex.data));
+    Engine::ref().gpu()->releaseData(std::move(gpu_.index.data));
+    gpu_.vertex.data = std::make_shared<std::vector<float>>();
+    std::vector<float>& vertex_data = *gpu_.vertex.data;
     for (uint32 i = 0; i < vertices_.size(); ++i)
     {
 #if VXR_MESH_PRECOMPUTE_TANGENTS
-      gpu_.vertex.data.push_back(tangents_[i].x);
-      gpu_.vertex.data.push_back(tangents_[i].y);
-      gpu_.vertex.data.push_back(tangents_[i].z);
-      gpu_.vertex.data.push_back(tangents_[i].w);
+      vertex_data.push_back(tangents_[i].x);
+      vertex_data.push_back(tangents_[i].y);
+      vertex_data.push_back(tangents_[i].z);
+      vertex_data.push_back(tangents_[i].w);
 #endif
-      gpu_.vertex.data.push_back(vertices_[i].x);
-      gpu_.vertex.data.push_back(vertices_[i].y);
-      gpu_.vertex.data.push_back(vertices_[i].z);
-      gpu_.vertex.data.push_back(normals_[i].x);
-      gpu_.vertex.data.push_back(normals_[i].y);
-      gpu_.vertex.data.push_back(normals_[i].z);
-      gpu_.vertex.data.push_back(uv_[i].x);
-      gpu_.vertex.data.push_back(uv_[i].y);
-    }
-    gpu_.index.data = indices_;
-
-    DisplayList add_to_frame;
-		size_t v_size = gpu_.vertex.data.size() * sizeof(float);
-		size_t i_size = gpu_.index.data.size() * sizeof(uint32);
-    if (!gpu_.vertex.buffer.id)
-    { 
-      /// TODO: This size is useless after the first mesh rebuild.
-      gpu_.vertex.buffer = Engine::ref().gpu()->createBuffer({ BufferType::Vertex, v_size, usage_ });
+      vertex_data.push_back(vertices_[i].x);
+      vertex_data.push_back(vertices_[i].y);
+      vertex_data.push_back(vertices_[i].z);
+      vertex_data.push_back(normals_[i].x);
+      vertex_data.push_back(normals_[i].y);
+      vertex_data.push_back(normals_[i].z);
+      vertex_data.push_back(uv_[i].x);
+      vertex_data.push_back(uv_[i].y);
     }
-    if (!gpu_.index.buffer.id)
+    gpu_.index.data = std::make_shared<std::vector<uint32>>(indices_);
+
+    ref_ptr<MeshArena> arena = Engine::ref().gpu()->meshArena();
+    arena->freeVertices(&gpu_.vertex.range);
+    arena->freeIndices(&gpu_.index.range);
+    uint32 vertex_size = (uint32)(vertex_data.size() / vertices_.size() * sizeof(float));
+    if (!arena->allocateVertices((uint32)vertices_.size(), vertex_size, &vertex_data[0], &gpu_.vertex.range) ||
+        !arena->allocateIndices((uint32)indices_.size(), &(*gpu_.index.data)[0], &gpu_.index.range))
     {
-      /// TODO: This size is useless after the first mesh rebuild.
-      gpu_.index.buffer = Engine::ref().gpu()->createBuffer({ BufferType::Index, i_size, usage_ });
+      VXR_LOG(VXR_DEBUG_LEVEL_ERROR, "[ERROR]: [MESH] Could not allocate the geometry of mesh object with name %s\n", name().c_str());
+      arena->freeVertices(&gpu_.vertex.range);
+      return false;
     }
-    add_to_frame.fillBufferCommand()
-      .set_buffer(gpu_.vertex.buffer)
-      .set_data(&gpu_.vertex.data[0])
-      .set_size(v_size);
-    add_to_frame.fillBufferCommand()
-      .set_buffer(gpu_.index.buffer)
-      .set_data(&gpu_.index.data[0])
-      .set_size(i_size);
-    Engine::ref().submitDisplayList(std::move(add_to_frame));
 
+    version_++;
     dirty_ = false;
     return true;
   }
@@ -160,11 +158,21 @@ namespace vxr
     return dirty_;
   }
 
+  uint32 Mesh::version() const
+  {
+    return version_;
+  }
+
   string Mesh::path() const
   {
     return path_;
   }
 
+  bool Mesh::loading() const
+  {
+    return loading_;
+  }
+
   uint32 Mesh::indexCount() const
   {
     return indices_.size();
@@ -175,14 +183,29 @@ namespace vxr
     return IndexFormat::UInt32;
   }
 
+  const Bounds& Mesh::bounds() const
+  {
+    return bounds_;
+  }
+
   gpu::Buffer Mesh::vertexBuffer() const
   {
-    return gpu_.vertex.buffer;
+    return Engine::ref().gpu()->meshArena()->vertexBuffer(gpu_.vertex.range);
   }
 
   gpu::Buffer Mesh::indexBuffer() const
   {
-    return gpu_.index.buffer;
+    return Engine::ref().gpu()->meshArena()->indexBuffer(gpu_.index.range);
+  }
+
+  uint32 Mesh::indexOffset() const
+  {
+    return gpu_.index.range.offset * sizeof(uint32);
+  }
+
+  uint32 Mesh::baseVertex() const
+  {
+    return gpu_.vertex.range.offset;
   }
 
   void Mesh::voxelize(vec3 voxel_size, double precision)
@@ -0,0 +1,406 @@
+// ----------------------------------------------------------------------------------------
+// MIT License
+// 
+// Copyright(c) 2018 Vctor vila
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ----------------------------------------------------------------------------------------
+
+#include "../../include/graphics/mesh_arena.h"
+
+#include "../../include/engine/engine.h"
+#include "../../include/engine/gpu.h"
+
+namespace vxr
+{
+
+  void RangeAllocator::init(uint32 size)
+  {
+    size_ = size;
+    used_ = 0;
+    free_by_offset_.clear();
+    free_by_size_.clear();
+    if (size)
+    {
+      insert(0, size);
+    }
+  }
+
+  uint32 RangeAllocator::allocate(uint32 count)
+  {
+    if (!count)
+    {
+      return kInvalid;
+    }
+    auto fit = free_by_size_.lower_bound(count);
+    if (fit == free_by_size_.end())
+    {
+      return kInvalid;
+    }
+    uint32 offset = fit->second;
+    uint32 free_count = fit->first;
+    erase(free_by_offset_.find(offset));
+    if (free_count > count)
+    {
+      insert(offset + count, free_count - count);
+    }
+    used_ += count;
+    return offset;
+  }
+
+  void RangeAllocator::free(uint32 offset, uint32 count)
+  {
+    if (!count)
+    {
+      return;
+    }
+    used_ -= count;
+    // Merge with the free ranges right after and right before the released one.
+    auto next = free_by_offset_.lower_bound(offset);
+    if (next != free_by_offset_.end() && next->first == offset + count)
+    {
+      count += next->second;
+      erase(next);
+    }
+    next = free_by_offset_.lower_bound(offset);
+    if (next != free_by_offset_.begin())
+    {
+      auto prev = std::prev(next);
+      if (prev->first + prev->second == offset)
+      {
+        offset = prev->first;
+        count += prev->second;
+        erase(prev);
+      }
+    }
+    insert(offset, count);
+  }
+
+  uint32 RangeAllocator::size() const
+  {
+    return size_;
+  }
+
+  uint32 RangeAllocator::used() const
+  {
+    return used_;
+  }
+
+  uint32 RangeAllocator::largest_free() const
+  {
+    return free_by_size_.empty() ? 0 : free_by_size_.rbegin()->first;
+  }
+
+  uint32 RangeAllocator::num_free_ranges() const
+  {
+    return (uint32)free_by_offset_.size();
+  }
+
+  float RangeAllocator::fragmentation() const
+  {
+    uint32 free_count = size_ - used_;
+    if (!free_count)
+    {
+      return 0.0f;
+    }
+    return 1.0f - (float)largest_free() / (float)free_count;
+  }
+
+  void RangeAllocator::insert(uint32 offset, uint32 count)
+  {
+    free_by_offset_[offset] = count;
+    free_by_size_.insert({ count, offset });
+  }
+
+  void RangeAllocator::erase(std::map<uint32, uint32>::iterator it)
+  {
+    auto range = free_by_size_.equal_range(it->second);
+    for (auto s = range.first; s != range.second; ++s)
+    {
+      if (s->second == it->first)
+      {
+        free_by_size_.erase(s);
+        break;
+      }
+    }
+    free_by_offset_.erase(it);
+  }
+
+  // -------------------------------------------------------------------------------------------------------
+
+  MeshArena::MeshArena()
+  {
+    set_name("Mesh Arena");
+    vertices_.type = BufferType::Vertex;
+    vertices_.block_size = kVertexBlockSize;
+    vertices_.name = "Mesh Arena Vertices";
+    indices_.type = BufferType::Index;
+    indices_.element_size = sizeof(uint32);
+    indices_.block_size = kIndexBlockSize;
+    indices_.name = "Mesh Arena Indices";
+  }
+
+  MeshArena::~MeshArena()
+  {
+    // Buffers die with the render context, only the bookkeeping is freed here.
+    for (Pool* pool : { &vertices_, &indices_ })
+    {
+      for (Block* block : pool->blocks)
+      {
+        delete block;
+      }
+    }
+  }
+
+  bool MeshArena::allocateVertices(uint32 count, uint32 vertex_size, const void* data, Range* range)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!vertices_.element_size)
+    {
+      vertices_.element_size = vertex_size;
+    }
+    if (vertices_.element_size != vertex_size)
+    {
+      VXR_LOG(VXR_DEBUG_LEVEL_ERROR, "[ERROR]: [MESH ARENA] Vertex size %u does not match the arena vertex size %u.\n", vertex_size, vertices_.element_size);
+      return false;
+    }
+    return allocate(&vertices_, count, data, range);
+  }
+
+  bool MeshArena::allocateIndices(uint32 count, const uint32* data, Range* range)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return allocate(&indices_, count, data, range);
+  }
+
+  void MeshArena::freeVertices(Range* range)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free(&vertices_, range);
+  }
+
+  void MeshArena::freeIndices(Range* range)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free(&indices_, range);
+  }
+
+  gpu::Buffer MeshArena::vertexBuffer(const Range& range) const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (range.block >= vertices_.blocks.size() || !vertices_.blocks[range.block])
+    {
+      return {};
+    }
+    return vertices_.blocks[range.block]->buffer;
+  }
+
+  gpu::Buffer MeshArena::indexBuffer(const Range& range) const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (range.block >= indices_.blocks.size() || !indices_.blocks[range.block])
+    {
+      return {};
+    }
+    return indices_.blocks[range.block]->buffer;
+  }
+
+  void MeshArena::defragment(float threshold)
+  {
+    VXR_TRACE_SCOPE("VXR", "Mesh Arena Defragment");
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (Pool* pool : { &vertices_, &indices_ })
+    {
+      for (Block* block : pool->blocks)
+      {
+        if (block && block->allocator.num_free_ranges() > 1 && block->allocator.fragmentation() > threshold)
+        {
+          compact(pool, block);
+          generation_++;
+        }
+      }
+    }
+  }
+
+  uint32 MeshArena::generation() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return generation_;
+  }
+
+  uint32 MeshArena::num_blocks() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32 count = 0;
+    for (const Pool* pool : { &vertices_, &indices_ })
+    {
+      for (const Block* block : pool->blocks)
+      {
+        count += block ? 1 : 0;
+      }
+    }
+    return count;
+  }
+
+  uint64 MeshArena::used_bytes() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64 bytes = 0;
+    for (const Pool* pool : { &vertices_, &indices_ })
+    {
+      for (const Block* block : pool->blocks)
+      {
+        bytes += block ? (uint64)block->allocator.used() * pool->element_size : 0;
+      }
+    }
+    return bytes;
+  }
+
+  uint64 MeshArena::allocated_bytes() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64 bytes = 0;
+    for (const Pool* pool : { &vertices_, &indices_ })
+    {
+      for (const Block* block : pool->blocks)
+      {
+        bytes += block ? (uint64)block->allocator.size() * pool->element_size : 0;
+      }
+    }
+    return bytes;
+  }
+
+  bool MeshArena::allocate(Pool* pool, uint32 count, const void* data, Range* range)
+  {
+    if (!count || !data)
+    {
+      return false;
+    }
+
+    uint32 block_index = kInvalidBlock;
+    uint32 offset = RangeAllocator::kInvalid;
+    for (uint32 i = 0; i < pool->blocks.size() && offset == RangeAllocator::kInvalid; ++i)
+    {
+      if (pool->blocks[i])
+      {
+        offset = pool->blocks[i]->allocator.allocate(count);
+        block_index = i;
+      }
+    }
+
+    if (offset == RangeAllocator::kInvalid)
+    {
+      // Meshes larger than a block get a dedicated one.
+      uint32 size = glm::max(pool->block_size / pool->element_size, count);
+      Block* block = new Block();
+      block->buffer = Engine::ref().gpu()->createBuffer({ pool->type, size * pool->element_size, Usage::Static, pool->name });
+      if (!block->buffer.id)
+      {
+        VXR_LOG(VXR_DEBUG_LEVEL_ERROR, "[ERROR]: [MESH ARENA] Could not create a %u bytes block for %s.\n", size * pool->element_size, pool->name);
+        delete block;
+        return false;
+      }
+      block->allocator.init(size);
+      offset = block->allocator.allocate(count);
+
+      block_index = (uint32)pool->blocks.size();
+      for (uint32 i = 0; i < pool->blocks.size(); ++i)
+      {
+        if (!pool->blocks[i])
+        {
+          block_index = i;
+          break;
+        }
+      }
+      if (block_index == pool->blocks.size())
+      {
+        pool->blocks.push_back(block);
+      }
+      else
+      {
+        pool->blocks[block_index] = block;
+      }
+    }
+
+    Block* block = pool->blocks[block_index];
+    range->block = block_index;
+    range->offset = offset;
+    range->count = count;
+    range->data = data;
+    block->ranges[offset] = range;
+    upload(*pool, *block, *range);
+    return true;
+  }
+
+  void MeshArena::free(Pool* pool, Range* range)
+  {
+    if (range->block >= pool->blocks.size() || !pool->blocks[range->block])
+    {
+      return;
+    }
+
+    Block* block = pool->blocks[range->block];
+    block->allocator.free(range->offset, range->count);
+    block->ranges.erase(range->offset);
+
+    // The first block is kept alive, the rest are released as soon as they become empty.
+    if (range->block && !block->allocator.used())
+    {
+      Engine::ref().gpu()->destroyBuffer(block->buffer);
+      delete block;
+      pool->blocks[range->block] = nullptr;
+    }
+
+    *range = Range();
+  }
+
+  void MeshArena::compact(Pool* pool, Block* block)
+  {
+    std::map<uint32, Range*> ranges;
+    uint32 offset = 0;
+    for (auto& it : block->ranges)
+    {
+      Range* range = it.second;
+      if (range->offset != offset)
+      {
+        range->offset = offset;
+        upload(*pool, *block, *range);
+      }
+      ranges[offset] = range;
+      offset += range->count;
+    }
+    block->ranges.swap(ranges);
+    block->allocator.init(block->allocator.size());
+    block->allocator.allocate(offset);
+  }
+
+  void MeshArena::upload(const Pool& pool, const Block& block, const Range& range)
+  {
+    DisplayList add_to_frame;
+    add_to_frame.fillBufferCommand()
+      .set_buffer(block.buffer)
+      .set_name(pool.name)
+      .set_offset(range.offset * pool.element_size)
+      .set_size(range.count * pool.element_size)
+      .set_data(range.data)
+      .set_persistent(true);
+    Engine::ref().submitDisplayList(std::move(add_to_frame));
+  }
+
+} /* end of vxr namespace */
\ No newline at end of file
@@ -0,0 +1,595 @@
+// ----------------------------------------------------------------------------------------
+// MIT License
+// 
+// Copyright(c) 2018 Vctor vila
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ----------------------------------------------------------------------------------------
+
+#include "../../include/graphics/mesh_lod.h"
+
+#include "../../include/engine/engine.h"
+#include "../../include/graphics/mesh.h"
+#include "../../include/graphics/frustum.h"
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <unordered_map>
+
+namespace vxr
+{
+
+  namespace lod
+  {
+
+    // Sum of squared distances to a set of planes: error(p) = p'Ap + 2b'p + c, A symmetric.
+    struct Quadric
+    {
+      double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+      double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+      double c = 0.0;
+
+      void addPlane(double nx, double ny, double nz, double d, double weight)
+      {
+        a00 += weight * nx * nx; a01 += weight * nx * ny; a02 += weight * nx * nz;
+        a11 += weight * ny * ny; a12 += weight * ny * nz; a22 += weight * nz * nz;
+        b0 += weight * nx * d; b1 += weight * ny * d; b2 += weight * nz * d;
+        c += weight * d * d;
+      }
+
+      void add(const Quadric& q)
+      {
+        a00 += q.a00; a01 += q.a01; a02 += q.a02; a11 += q.a11; a12 += q.a12; a22 += q.a22;
+        b0 += q.b0; b1 += q.b1; b2 += q.b2;
+        c += q.c;
+      }
+
+      double error(const vec3& p) const
+      {
+        double x = p.x, y = p.y, z = p.z;
+        double e = a00 * x * x + a11 * y * y + a22 * z * z + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+          2.0 * (b0 * x + b1 * y + b2 * z) + c;
+        return (e > 0.0) ? e : 0.0;
+      }
+    };
+
+    struct Collapse
+    {
+      double cost;
+      uint32 from;
+      uint32 to;
+
+      bool operator<(const Collapse& other) const { return cost < other.cost; }
+    };
+
+    struct PositionHash
+    {
+      size_t operator()(const vec3& p) const
+      {
+        uint32 h[3];
+        memcpy(h, &p, sizeof(h));
+        return (size_t)((h[0] * 73856093u) ^ (h[1] * 19349663u) ^ (h[2] * 83492791u));
+      }
+    };
+
+    static vec3 TriangleNormal(const vec3& p0, const vec3& p1, const vec3& p2)
+    {
+      return glm::cross(p1 - p0, p2 - p0);
+    }
+
+    float Simplify(const std::vector<vec3>& positions, const std::vector<uint32>& indices, uint32 target_index_count, float max_error, std::vector<uint32>* result)
+    {
+      VXR_TRACE_SCOPE("VXR", "Simplify Mesh");
+      *result = indices;
+      const uint32 num_vertices = (uint32)positions.size();
+      if (indices.size() <= target_index_count || num_vertices == 0)
+      {
+        return 0.0f;
+      }
+
+      // Errors are measured relative to the size of the mesh.
+      const double scale = glm::max((double)Bounds::FromPoints(positions).radius, 1e-6);
+      const double max_cost = (max_error * scale) * (max_error * scale);
+
+      // Vertices sharing a position are welded to the first of them. They are split by some other 
+      // attribute, moving them would tear the seam.
+      std::vector<uint32> weld(num_vertices);
+      std::vector<uint8> locked(num_vertices, 0);
+      std::unordered_map<vec3, uint32, PositionHash> first_vertex;
+      for (uint32 i = 0; i < num_vertices; ++i)
+      {
+        auto it = first_vertex.emplace(positions[i], i);
+        weld[i] = it.first->second;
+        if (!it.second)
+        {
+          locked[i] = 1;
+          locked[it.first->second] = 1;
+        }
+      }
+
+      // Edges without a twin lie on open borders, moving their vertices would shrink the border.
+      std::unordered_map<uint64, uint32> edges;
+      for (uint32 i = 0; i < indices.size(); i += 3)
+      {
+        for (uint32 e = 0; e < 3; ++e)
+        {
+          uint64 a = weld[indices[i + e]], b = weld[indices[i + (e + 1) % 3]];
+          edges[(a << 32) | b]++;
+        }
+      }
+      for (uint32 i = 0; i < indices.size(); i += 3)
+      {
+        for (uint32 e = 0; e < 3; ++e)
+        {
+          uint32 a = indices[i + e], b = indices[i + (e + 1) % 3];
+          if (edges.find(((uint64)weld[b] << 32) | weld[a]) == edges.end())
+          {
+            locked[a] = 1;
+            locked[b] = 1;
+          }
+        }
+      }
+
+      // Every vertex starts with the planes of its triangles, weighted by their area.
+      std::vector<Quadric> quadrics(num_vertices);
+      for (uint32 i = 0; i < indices.size(); i += 3)
+      {
+        const vec3& p0 = positions[indices[i]];
+        vec3 n = TriangleNormal(p0, positions[indices[i + 1]], positions[indices[i + 2]]);
+        double length = glm::length(n);
+        if (length == 0.0)
+        {
+          continue;
+        }
+        double nx = n.x / length, ny = n.y / length, nz = n.z / length;
+        double d = -(nx * p0.x + ny * p0.y + nz * p0.z);
+        for (uint32 e = 0; e < 3; ++e)
+        {
+          quadrics[weld[indices[i + e]]].addPlane(nx, ny, nz, d, length * 0.5);
+        }
+      }
+
+      double error = 0.0;
+      std::vector<uint32> offsets;
+      std::vector<uint32> adjacency;
+      std::vector<uint32> remap(num_vertices);
+      std::vector<uint8> touched;
+      std::vector<Collapse> best;
+      std::vector<Collapse> collapses;
+      std::vector<uint32> next;
+      while (result->size() > target_index_count)
+      {
+        const std::vector<uint32>& current = *result;
+        const uint32 num_indices = (uint32)current.size();
+
+        // Triangles around each vertex.
+        offsets.assign(num_vertices + 1, 0);
+        for (uint32 index : current)
+        {
+          offsets[index + 1]++;
+        }
+        for (uint32 i = 0; i < num_vertices; ++i)
+        {
+          offsets[i + 1] += offsets[i];
+        }
+        adjacency.resize(num_indices);
+        std::vector<uint32> cursor(offsets.begin(), offsets.end() - 1);
+        for (uint32 i = 0; i < num_indices; ++i)
+        {
+          adjacency[cursor[current[i]]++] = i / 3;
+        }
+
+        // Cheapest collapse of every vertex that may move, onto one of its neighbours.
+        best.assign(num_vertices, { std::numeric_limits<double>::max(), 0, 0 });
+        for (uint32 i = 0; i < num_indices; i += 3)
+        {
+          for (uint32 e = 0; e < 3; ++e)
+          {
+            uint32 a = current[i + e], b = current[i + (e + 1) % 3];
+            for (uint32 k = 0; k < 2; ++k)
+            {
+              uint32 from = k ? b : a, to = k ? a : b;
+              if (locked[from])
+              {
+                continue;
+              }
+              double cost = quadrics[weld[from]].error(positions[to]) + quadrics[weld[to]].error(positions[to]);
+              if (cost < best[from].cost)
+              {
+                best[from] = { cost, from, to };
+              }
+            }
+          }
+        }
+
+        collapses.clear();
+        for (uint32 i = 0; i < num_vertices; ++i)
+        {
+          if (best[i].cost <= max_cost)
+          {
+            collapses.push_back(best[i]);
+          }
+        }
+        std::sort(collapses.begin(), collapses.end());
+
+        // Cheapest collapses first, at most one per neighbourhood so that flip tests stay valid.
+        for (uint32 i = 0; i < num_vertices; ++i)
+        {
+          remap[i] = i;
+        }
+        touched.assign(num_vertices, 0);
+        uint32 index_count = num_indices;
+        uint32 num_collapses = 0;
+        for (const Collapse& collapse : collapses)
+        {
+          if (index_count <= target_index_count)
+          {
+            break;
+          }
+          if (touched[collapse.from] || touched[collapse.to])
+          {
+            continue;
+          }
+
+          bool flips = false;
+          uint32 removed = 0;
+          for (uint32 k = offsets[collapse.from]; k < offsets[collapse.from + 1] && !flips; ++k)
+          {
+            const uint32* t = &current[adjacency[k] * 3];
+            if (t[0] == collapse.to || t[1] == collapse.to || t[2] == collapse.to)
+            {
+              removed++;
+              continue;
+            }
+            vec3 p[3] = { positions[t[0]], positions[t[1]], positions[t[2]] };
+            vec3 before = TriangleNormal(p[0], p[1], p[2]);
+            for (uint32 e = 0; e < 3; ++e)
+            {
+              if (t[e] == collapse.from)
+              {
+                p[e] = positions[collapse.to];
+              }
+            }
+            flips = glm::dot(before, TriangleNormal(p[0], p[1], p[2])) <= 0.0f;
+          }
+          if (flips)
+          {
+            continue;
+          }
+
+          remap[collapse.from] = collapse.to;
+          quadrics[weld[collapse.to]].add(quadrics[weld[collapse.from]]);
+          error = glm::max(error, collapse.cost);
+          index_count -= removed * 3;
+          num_collapses++;
+          for (uint32 k = offsets[collapse.from]; k < offsets[collapse.from + 1]; ++k)
+          {
+            const uint32* t = &current[adjacency[k] * 3];
+            touched[t[0]] = touched[t[1]] = touched[t[2]] = 1;
+          }
+        }
+
+        if (num_collapses == 0)
+        {
+          break;
+        }
+
+        // Collapsed triangles become degenerate and are dropped.
+        next.clear();
+        for (uint32 i = 0; i < num_indices; i += 3)
+        {
+          uint32 a = remap[current[i]], b = remap[current[i + 1]], c = remap[current[i + 2]];
+          if (a != b && b != c && a != c)
+          {
+            next.push_back(a);
+            next.push_back(b);
+            next.push_back(c);
+          }
+        }
+        result->swap(next);
+      }
+
+      return (float)(sqrt(error) / scale);
+    }
+
+  } /* end of lod namespace */
+
+  MeshLOD::MeshLOD() :
+    state_(State::Idle),
+    version_(0)
+  {
+    set_name("Mesh LOD");
+    set_params(Params());
+  }
+
+  MeshLOD::~MeshLOD()
+  {
+  }
+
+  void MeshLOD::onGUI()
+  {
+    for (uint32 i = 0; i < num_levels(); ++i)
+    {
+      ImGui::Text("LOD %d: %d triangles", i, levels_[i]->indexCount() / 3);
+    }
+  }
+
+  void MeshLOD::set_source(ref_ptr<Mesh> mesh, const string& cache_file)
+  {
+    source_ = mesh;
+    cache_file_ = cache_file;
+    levels_.clear();
+    data_.clear();
+    state_ = State::Idle;
+  }
+
+  void MeshLOD::set_params(const Params& params)
+  {
+    params_ = params;
+    params_.num_levels = glm::clamp(params_.num_levels, 1u, kMaxLevels);
+
+    screen_sizes_[0] = std::numeric_limits<float>::max();
+    for (uint32 i = 1; i < kMaxLevels; ++i)
+    {
+      screen_sizes_[i] = params_.screen_size / (float)(1 << (i - 1));
+    }
+  }
+
+  ref_ptr<Mesh> MeshLOD::source() const
+  {
+    return source_;
+  }
+
+  bool MeshLOD::build()
+  {
+    if (state_ == State::Ready)
+    {
+      return true;
+    }
+
+    if (state_ == State::Idle)
+    {
+      if (!source_ || source_->loading() || source_->vertices().empty() || source_->indices().empty())
+      {
+        return false;
+      }
+
+      state_ = State::Generating;
+#ifdef VXR_THREADING
+      // The chain must outlive the task, see AssetManager::loadMeshLOD.
+      threading::Sync sync;
+      threading::Task task = [this]() { generate(); };
+      Engine::ref().submitAsyncTask(task, &sync);
+#else
+      generate();
+#endif
+    }
+
+    if (state_ != State::Generated)
+    {
+      return false;
+    }
+
+    // Meshes are ref counted objects, so they are only created on this thread.
+    VXR_TRACE_SCOPE("VXR", "Build Mesh LOD");
+    const std::vector<vec3>& vertices = source_->vertices();
+    const std::vector<vec3>& normals = source_->normals();
+    const std::vector<vec2>& uv = source_->uv();
+    const std::vector<vec4>& tangents = source_->tangents();
+    levels_.clear();
+    levels_.push_back(source_);
+    for (uint32 i = 0; i < data_.size(); ++i)
+    {
+      const LevelData& data = data_[i];
+      std::vector<vec3> level_vertices, level_normals;
+      std::vector<vec2> level_uv;
+      std::vector<vec4> level_tangents;
+      for (uint32 v : data.vertices)
+      {
+        level_vertices.push_back(vertices[v]);
+        if (normals.size() == vertices.size()) level_normals.push_back(normals[v]);
+        if (uv.size() == vertices.size()) level_uv.push_back(uv[v]);
+        if (tangents.size() == vertices.size()) level_tangents.push_back(tangents[v]);
+      }
+
+      ref_ptr<Mesh> level;
+      level.alloc()->set_name(source_->name() + " LOD " + std::to_string(i + 1));
+      level->set_vertices(level_vertices);
+      level->set_normals(level_normals);
+      level->set_uv(level_uv);
+      level->set_tangents(level_tangents);
+      level->set_indices(data.indices);
+      levels_.push_back(level);
+    }
+    data_.clear();
+
+    state_ = State::Ready;
+    version_++;
+    return true;
+  }
+
+  uint32 MeshLOD::num_levels() const
+  {
+    return (uint32)levels_.size();
+  }
+
+  ref_ptr<Mesh> MeshLOD::level(uint32 index) const
+  {
+    return levels_[index];
+  }
+
+  float MeshLOD::screen_size(uint32 index) const
+  {
+    return screen_sizes_[index];
+  }
+
+  void MeshLOD::set_screen_size(uint32 index, float screen_size)
+  {
+    if (index == 0 || index >= kMaxLevels)
+    {
+      VXR_LOG(VXR_DEBUG_LEVEL_WARNING, "[WARNING]: [MESH] Invalid level of detail %d, level 0 is always drawn above level 1.\n", index);
+      return;
+    }
+    screen_sizes_[index] = screen_size;
+  }
+
+  uint32 MeshLOD::version() const
+  {
+    return version_;
+  }
+
+  void MeshLOD::generate()
+  {
+    VXR_TRACE_SCOPE("VXR", "Generate Mesh LOD");
+    if (!load())
+    {
+      const std::vector<vec3>& positions = source_->vertices();
+      std::vector<uint32> indices = source_->indices();
+      std::vector<uint32> simplified;
+      std::vector<uint32> vertex_map(positions.size());
+      for (uint32 i = 1; i < params_.num_levels; ++i)
+      {
+        uint32 target = (uint32)(indices.size() / 3 * params_.reduction) * 3;
+        LevelData level;
+        level.error = lod::Simplify(positions, indices, target, params_.max_error, &simplified);
+
+        // Stop when the error limit or locked seams leave the level too close to the previous one.
+        if (simplified.empty() || simplified.size() > indices.size() - indices.size() / 10)
+        {
+          break;
+        }
+
+        // Levels only keep the vertices they use.
+        std::fill(vertex_map.begin(), vertex_map.end(), 0xFFFFFFFF);
+        for (uint32 index : simplified)
+        {
+          if (vertex_map[index] == 0xFFFFFFFF)
+          {
+            vertex_map[index] = (uint32)level.vertices.size();
+            level.vertices.push_back(index);
+          }
+          level.indices.push_back(vertex_map[index]);
+        }
+        data_.push_back(level);
+        indices.swap(simplified);
+      }
+      save();
+    }
+
+    VXR_LOG(VXR_DEBUG_LEVEL_INFO, "[INFO]: [MESH] Generated %d levels of detail of %s.\n", (int)data_.size() + 1, source_->name().c_str());
+    state_ = State::Generated;
+  }
+
+  static const uint32 kCacheMagic = 0x444F4C56; // "VLOD"
+  static const uint32 kCacheVersion = 1;
+
+  bool MeshLOD::load()
+  {
+    if (cache_file_.empty())
+    {
+      return false;
+    }
+
+    std::ifstream file(cache_file_, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+    {
+      return false;
+    }
+
+    // The cache is only valid for the same source mesh and parameters.
+    uint32 header[5];
+    float params[2];
+    file.read((char*)header, sizeof(header));
+    file.read((char*)params, sizeof(params));
+    const uint32 num_vertices = (uint32)source_->vertices().size();
+    if (!file || header[0] != kCacheMagic || header[1] != kCacheVersion || header[2] != num_vertices ||
+        header[3] != (uint32)source_->indices().size() || header[4] != params_.num_levels ||
+        params[0] != params_.reduction || params[1] != params_.max_error)
+    {
+      return false;
+    }
+
+    uint32 num_data = 0;
+    file.read((char*)&num_data, sizeof(num_data));
+    if (!file || num_data >= kMaxLevels)
+    {
+      return false;
+    }
+
+    data_.resize(num_data);
+    for (LevelData& level : data_)
+    {
+      uint32 counts[2] = { 0, 0 };
+      file.read((char*)&level.error, sizeof(level.error));
+      file.read((char*)counts, sizeof(counts));
+      if (!file || counts[0] > num_vertices || counts[1] > source_->indices().size())
+      {
+        data_.clear();
+        return false;
+      }
+      level.vertices.resize(counts[0]);
+      level.indices.resize(counts[1]);
+      file.read((char*)level.vertices.data(), counts[0] * sizeof(uint32));
+      file.read((char*)level.indices.data(), counts[1] * sizeof(uint32));
+      bool valid = !!file;
+      for (uint32 i = 0; valid && i < counts[0]; ++i) valid = level.vertices[i] < num_vertices;
+      for (uint32 i = 0; valid && i < counts[1]; ++i) valid = level.indices[i] < counts[0];
+      if (!valid)
+      {
+        VXR_LOG(VXR_DEBUG_LEVEL_WARNING, "[WARNING]: [MESH] Invalid level of detail cache %s, generating it again.\n", cache_file_.c_str());
+        data_.clear();
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  void MeshLOD::save() const
+  {
+    if (cache_file_.empty())
+    {
+      return;
+    }
+
+    std::ofstream file(cache_file_, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+      VXR_LOG(VXR_DEBUG_LEVEL_WARNING, "[WARNING]: [MESH] Could not write level of detail cache %s.\n", cache_file_.c_str());
+      return;
+    }
+
+    uint32 header[5] = { kCacheMagic, kCacheVersion, (uint32)source_->vertices().size(), (uint32)source_->indices().size(), params_.num_levels };
+    float params[2] = { params_.reduction, params_.max_error };
+    uint32 num_data = (uint32)data_.size();
+    file.write((const char*)header, sizeof(header));
+    file.write((const char*)params, sizeof(params));
+    file.write((const char*)&num_data, sizeof(num_data));
+    for (const LevelData& level : data_)
+    {
+      uint32 counts[2] = { (uint32)level.vertices.size(), (uint32)level.indices.size() };
+      file.write((const char*)&level.error, sizeof(level.error));
+      file.write((const char*)counts, sizeof(counts));
+      file.write((const char*)level.vertices.data(), counts[0] * sizeof(uint32));
+      file.write((const char*)level.indices.data(), counts[1] * sizeof(uint32));
+    }
+  }
+
+} /* end of vxr namespace */
\ No newline at end of file
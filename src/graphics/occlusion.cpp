@@ -0,0 +1,300 @@
+// ----------------------------------------------------------------------------------------
+// MIT License
+// 
+// Copyright(c) 2018 Vctor vila
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ----------------------------------------------------------------------------------------
+
+#include "../../include/graphics/occlusion.h"
+
+#include <float.h>
+
+#if VXR_SIMD
+#  include <xmmintrin.h>
+#endif
+
+namespace vxr
+{
+
+  // Triangles with a vertex nearer than this (clip space w) are not rasterized.
+  static const float kMinW = 1e-3f;
+
+  void OcclusionBuffer::resize(uint32 width, uint32 height)
+  {
+    tiles_x_ = (width + kTileWidth - 1) / kTileWidth;
+    tiles_y_ = (height + kTileHeight - 1) / kTileHeight;
+    width_ = tiles_x_ * kTileWidth;
+    height_ = tiles_y_ * kTileHeight;
+    tiles_.resize(tiles_x_ * tiles_y_);
+    bands_.resize((tiles_y_ + kTilesPerBand - 1) / kTilesPerBand);
+  }
+
+  void OcclusionBuffer::begin(const mat4& view_projection)
+  {
+    view_projection_ = view_projection;
+    for (Tile& tile : tiles_)
+    {
+      tile = { FLT_MAX, 0.0f, 0 };
+    }
+    triangles_.clear();
+    for (std::vector<uint32>& band : bands_)
+    {
+      band.clear();
+    }
+  }
+
+  void OcclusionBuffer::addOccluder(const mat4& model, const std::vector<vec3>& vertices, const std::vector<uint32>& indices)
+  {
+    const mat4 transform = view_projection_ * model;
+    clip_.resize(vertices.size());
+    for (uint32 i = 0; i < vertices.size(); ++i)
+    {
+      clip_[i] = transform * vec4(vertices[i], 1.0f);
+    }
+
+    const vec2 half_size = vec2(width_, height_) * 0.5f;
+    const uint32 band_height = kTileHeight * kTilesPerBand;
+    for (uint32 i = 0; i + 2 < indices.size(); i += 3)
+    {
+      const vec4& c0 = clip_[indices[i]];
+      const vec4& c1 = clip_[indices[i + 1]];
+      const vec4& c2 = clip_[indices[i + 2]];
+      if (c0.w < kMinW || c1.w < kMinW || c2.w < kMinW)
+      {
+        continue;
+      }
+
+      vec2 p[3] = { 
+        (vec2(c0) / c0.w + 1.0f) * half_size, 
+        (vec2(c1) / c1.w + 1.0f) * half_size, 
+        (vec2(c2) / c2.w + 1.0f) * half_size 
+      };
+
+      // Counter clockwise (front facing) triangles have a positive area.
+      float area = (p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[2].x - p[0].x) * (p[1].y - p[0].y);
+      if (area <= 0.0f)
+      {
+        continue;
+      }
+
+      // Bounds are clamped to the buffer (with one pixel of margin) before converting them to pixels.
+      const vec2 limit = vec2(width_, height_);
+      vec2 min = glm::clamp(glm::min(p[0], glm::min(p[1], p[2])), vec2(-1.0f), limit);
+      vec2 max = glm::clamp(glm::max(p[0], glm::max(p[1], p[2])), vec2(-1.0f), limit);
+
+      Triangle t;
+      t.min_x = glm::max((int32)glm::floor(min.x), 0);
+      t.min_y = glm::max((int32)glm::floor(min.y), 0);
+      t.max_x = glm::min((int32)glm::floor(max.x), (int32)width_ - 1);
+      t.max_y = glm::min((int32)glm::floor(max.y), (int32)height_ - 1);
+      if (t.min_x > t.max_x || t.min_y > t.max_y)
+      {
+        continue;
+      }
+
+      for (uint32 e = 0; e < 3; ++e)
+      {
+        const vec2& a = p[e];
+        const vec2& b = p[(e + 1) % 3];
+        t.a[e] = a.y - b.y;
+        t.b[e] = b.x - a.x;
+        t.c[e] = a.x * b.y - a.y * b.x;
+      }
+      t.depth = glm::max(c0.w, glm::max(c1.w, c2.w));
+
+      const uint32 index = (uint32)triangles_.size();
+      triangles_.push_back(t);
+      for (uint32 band = t.min_y / band_height; band <= (uint32)t.max_y / band_height; ++band)
+      {
+        bands_[band].push_back(index);
+      }
+    }
+  }
+
+  void OcclusionBuffer::rasterize(uint32 band)
+  {
+    VXR_TRACE_SCOPE("VXR", "Rasterize Occluders");
+    const uint32 first_row = band * kTilesPerBand;
+    const uint32 last_row = glm::min(first_row + kTilesPerBand, tiles_y_) - 1;
+#if VXR_SIMD
+    const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    const __m128 zero = _mm_setzero_ps();
+#endif
+
+    for (uint32 index : bands_[band])
+    {
+      const Triangle& t = triangles_[index];
+      const uint32 min_ty = glm::max((uint32)t.min_y / kTileHeight, first_row);
+      const uint32 max_ty = glm::min((uint32)t.max_y / kTileHeight, last_row);
+      const uint32 min_tx = (uint32)t.min_x / kTileWidth;
+      const uint32 max_tx = (uint32)t.max_x / kTileWidth;
+      for (uint32 ty = min_ty; ty <= max_ty; ++ty)
+      {
+        for (uint32 tx = min_tx; tx <= max_tx; ++tx)
+        {
+          Tile* tile = &tiles_[ty * tiles_x_ + tx];
+          if (t.depth >= tile->z0)
+          {
+            continue;
+          }
+
+          // One bit per pixel center covered by the triangle, row by row.
+          uint32 coverage = 0;
+          const float x0 = (float)(tx * kTileWidth);
+          const float y0 = (float)(ty * kTileHeight);
+#if VXR_SIMD
+          if (simd_)
+          {
+            for (uint32 half = 0; half < 2; ++half)
+            {
+              __m128 x = _mm_add_ps(_mm_set1_ps(x0 + half * 4.0f), offsets);
+              __m128 ex[3];
+              for (uint32 e = 0; e < 3; ++e)
+              {
+                ex[e] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.a[e]), x), _mm_set1_ps(t.c[e]));
+              }
+              for (uint32 row = 0; row < kTileHeight; ++row)
+              {
+                const float y = y0 + row + 0.5f;
+                __m128 e0 = _mm_add_ps(ex[0], _mm_set1_ps(t.b[0] * y));
+                __m128 e1 = _mm_add_ps(ex[1], _mm_set1_ps(t.b[1] * y));
+                __m128 e2 = _mm_add_ps(ex[2], _mm_set1_ps(t.b[2] * y));
+                __m128 inside = _mm_cmpge_ps(_mm_min_ps(e0, _mm_min_ps(e1, e2)), zero);
+                coverage |= (uint32)_mm_movemask_ps(inside) << (row * kTileWidth + half * 4);
+              }
+            }
+          }
+          else
+#endif
+          {
+            for (uint32 row = 0; row < kTileHeight; ++row)
+            {
+              const float y = y0 + row + 0.5f;
+              for (uint32 col = 0; col < kTileWidth; ++col)
+              {
+                const float x = x0 + col + 0.5f;
+                // Same order of operations as the SIMD path, so that both cover the same pixels.
+                bool inside = true;
+                for (uint32 e = 0; e < 3; ++e)
+                {
+                  inside = inside && ((t.a[e] * x + t.c[e]) + t.b[e] * y >= 0.0f);
+                }
+                coverage |= (uint32)inside << (row * kTileWidth + col);
+              }
+            }
+          }
+          if (coverage)
+          {
+            update(tile, coverage, t.depth);
+          }
+        }
+      }
+    }
+  }
+
+  void OcclusionBuffer::update(Tile* tile, uint32 coverage, float depth)
+  {
+    // A triangle much nearer than the working layer starts a new one, merging them would push the
+    // layer too far to be useful.
+    if (tile->z1 - depth > tile->z0 - tile->z1)
+    {
+      tile->z1 = 0.0f;
+      tile->mask = 0;
+    }
+
+    tile->z1 = glm::max(tile->z1, depth);
+    tile->mask |= coverage;
+    if (tile->mask == 0xFFFFFFFF)
+    {
+      tile->z0 = glm::min(tile->z0, tile->z1);
+      tile->z1 = 0.0f;
+      tile->mask = 0;
+    }
+  }
+
+  bool OcclusionBuffer::occluded(const vec3& center, const vec3& extents) const
+  {
+    const vec4 c = view_projection_ * vec4(center, 1.0f);
+    const vec4 axes[3] = { view_projection_[0] * extents.x, view_projection_[1] * extents.y, view_projection_[2] * extents.z };
+
+    vec2 min = vec2(FLT_MAX), max = vec2(-FLT_MAX);
+    float nearest = FLT_MAX;
+    for (uint32 i = 0; i < 8; ++i)
+    {
+      vec4 corner = c + ((i & 1) ? axes[0] : -axes[0]) + ((i & 2) ? axes[1] : -axes[1]) + ((i & 4) ? axes[2] : -axes[2]);
+      if (corner.w < kMinW)
+      {
+        return false;
+      }
+      vec2 p = (vec2(corner) / corner.w + 1.0f) * vec2(width_, height_) * 0.5f;
+      min = glm::min(min, p);
+      max = glm::max(max, p);
+      nearest = glm::min(nearest, corner.w);
+    }
+
+    if (max.x < 0.0f || max.y < 0.0f || min.x >= (float)width_ || min.y >= (float)height_)
+    {
+      return false;
+    }
+
+    // Every overlapped tile must be nearer than the box.
+    const uint32 min_tx = (uint32)glm::max(min.x, 0.0f) / kTileWidth;
+    const uint32 min_ty = (uint32)glm::max(min.y, 0.0f) / kTileHeight;
+    const uint32 max_tx = (uint32)glm::min(max.x, (float)(width_ - 1)) / kTileWidth;
+    const uint32 max_ty = (uint32)glm::min(max.y, (float)(height_ - 1)) / kTileHeight;
+    for (uint32 ty = min_ty; ty <= max_ty; ++ty)
+    {
+      for (uint32 tx = min_tx; tx <= max_tx; ++tx)
+      {
+        if (nearest <= tiles_[ty * tiles_x_ + tx].z0)
+        {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  uint32 OcclusionBuffer::width() const
+  {
+    return width_;
+  }
+
+  uint32 OcclusionBuffer::height() const
+  {
+    return height_;
+  }
+
+  uint32 OcclusionBuffer::num_bands() const
+  {
+    return (uint32)bands_.size();
+  }
+
+  uint32 OcclusionBuffer::num_triangles() const
+  {
+    return (uint32)triangles_.size();
+  }
+
+  void OcclusionBuffer::set_simd(bool enabled)
+  {
+    simd_ = enabled;
+  }
+
+} /* end of vxr namespace */
\ No newline at end of file
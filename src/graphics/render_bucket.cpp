@@ -0,0 +1,153 @@
+// ----------------------------------------------------------------------------------------
+// MIT License
+// 
+// Copyright(c) 2018 Vctor vila
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ----------------------------------------------------------------------------------------
+
+#include "../../include/graphics/render_bucket.h"
+
+#include <cstring>
+
+namespace vxr
+{
+
+  RenderBucket::RenderBucket()
+  {
+  }
+
+  RenderBucket::~RenderBucket()
+  {
+  }
+
+  // Non-negative floats keep their order when compared as unsigned integers.
+  static uint32 DepthBits(float depth)
+  {
+    if (!(depth > 0.0f))
+    {
+      return 0;
+    }
+    uint32 bits;
+    memcpy(&bits, &depth, sizeof(bits));
+    return bits;
+  }
+
+  uint64 RenderBucket::OpaqueKey(uint32 layer, uint32 pass, uint32 program, uint32 texture_set, float depth)
+  {
+    return ((uint64)(layer & 0xF) << 60)
+         | ((uint64)(pass & 0xF) << 56)
+         | ((uint64)(program & 0xFFF) << 43)
+         | ((uint64)(texture_set & 0x7FF) << 32)
+         | ((uint64)DepthBits(depth));
+  }
+
+  uint64 RenderBucket::TransparentKey(uint32 layer, uint32 pass, uint32 program, uint32 texture_set, float depth)
+  {
+    return ((uint64)(layer & 0xF) << 60)
+         | ((uint64)(pass & 0xF) << 56)
+         | ((uint64)1 << 55)
+         | ((uint64)(~DepthBits(depth)) << 23)
+         | ((uint64)(program & 0xFFF) << 11)
+         | ((uint64)(texture_set & 0x7FF));
+  }
+
+  uint64 RenderBucket::FrontToBackKey(uint32 layer, uint32 pass, uint32 program, uint32 texture_set, float depth)
+  {
+    return ((uint64)(layer & 0xF) << 60)
+         | ((uint64)(pass & 0xF) << 56)
+         | ((uint64)DepthBits(depth) << 23)
+         | ((uint64)(program & 0xFFF) << 11)
+         | ((uint64)(texture_set & 0x7FF));
+  }
+
+  void RenderBucket::clear()
+  {
+    entries_.clear();
+  }
+
+  void RenderBucket::add(uint64 key, uint32 index)
+  {
+    entries_.push_back({ key, index });
+  }
+
+  void RenderBucket::sort()
+  {
+    VXR_TRACE_SCOPE("VXR", "Render Bucket Sort");
+    const uint32 count = (uint32)entries_.size();
+    if (count < 2)
+    {
+      return;
+    }
+
+    // LSD radix sort, 8 bits per pass. Stable, so equal keys keep their submission order.
+    scratch_.resize(count);
+    Entry* src = entries_.data();
+    Entry* dst = scratch_.data();
+    for (uint32 shift = 0; shift < 64; shift += 8)
+    {
+      uint32 histogram[256] = {};
+      for (uint32 i = 0; i < count; ++i)
+      {
+        histogram[(src[i].key >> shift) & 0xFF]++;
+      }
+
+      // Skip the pass if every key shares the same digit.
+      if (histogram[(src[0].key >> shift) & 0xFF] == count)
+      {
+        continue;
+      }
+
+      uint32 offset = 0;
+      for (uint32 i = 0; i < 256; ++i)
+      {
+        uint32 n = histogram[i];
+        histogram[i] = offset;
+        offset += n;
+      }
+
+      for (uint32 i = 0; i < count; ++i)
+      {
+        dst[histogram[(src[i].key >> shift) & 0xFF]++] = src[i];
+      }
+      std::swap(src, dst);
+    }
+
+    if (src != entries_.data())
+    {
+      entries_.swap(scratch_);
+    }
+  }
+
+  uint32 RenderBucket::size() const
+  {
+    return (uint32)entries_.size();
+  }
+
+  uint32 RenderBucket::index(uint32 i) const
+  {
+    return entries_[i].index;
+  }
+
+  uint64 RenderBucket::key(uint32 i) const
+  {
+    return entries_[i].key;
+  }
+
+} /* end of vxr namespace */
\ No newline at end of file
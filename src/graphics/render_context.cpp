@@ -30,8 +30,10 @@
 #  include "../graphics/backend/opengl/gl_backend.h"
 #elif defined (VXR_DX11)
 #  include "../graphics/backend/dx11/dx11_backend.h"
+#elif defined (VXR_NULL)
+#  include "../graphics/backend/null/null_backend.h"
 #else
-#  error Backend must be defined on GENie.lua (e.g. try parameters --gl OR --dx11).
+#  error Backend must be defined on GENie.lua (e.g. try parameters --gl, --dx11 OR --null).
 #endif
 
 namespace vxr
@@ -55,7 +57,70 @@ namespace vxr
     materials_.alloc(params.max_materials);
     framebuffers_.alloc(params.max_framebuffers);
 
-    VXR_LOG(VXR_DEBUG_LEVEL_INFO, "[INFO]: [GPU] Initialized Render Context with params:\n    - max_buffers       (%u)\n    - max_textures      (%u)\n    - max_materials     (%u)\n    - max_framebuffers  (%u)\n", params.max_buffers, params.max_textures, params.max_materials, params.max_framebuffers);
+    free_buffers_.grow((uint32)buffers_.size());
+    free_textures_.grow((uint32)textures_.size());
+    free_materials_.grow((uint32)materials_.size());
+    free_framebuffers_.grow((uint32)framebuffers_.size());
+
+    VXR_LOG(VXR_DEBUG_LEVEL_INFO, "[INFO]: [GPU] Initialized Render Context with params (initial pool sizes, pages of %u):\n    - max_buffers       (%u)\n    - max_textures      (%u)\n    - max_materials     (%u)\n    - max_framebuffers  (%u)\n", (uint32)buffers_.page_size(), (uint32)buffers_.size(), (uint32)textures_.size(), (uint32)materials_.size(), (uint32)framebuffers_.size());
+  }
+
+  void RenderContext::SetInstanceMemory(gpu::InstanceBase* instance, uint64 bytes, Memory* memory)
+  {
+    if (instance->bytes == bytes)
+    {
+      return;
+    }
+    uint64 total = memory->bytes.fetch_add(bytes - instance->bytes) + bytes - instance->bytes;
+    instance->bytes = bytes;
+    uint64 peak = memory->peak_bytes.load(std::memory_order_relaxed);
+    while (total > peak && !memory->peak_bytes.compare_exchange_weak(peak, total)) {}
+  }
+
+  uint64 RenderContext::TextureMemory(const gpu::TextureInstance& texture, bool mipmaps)
+  {
+    const gpu::Texture::Info& info = texture.info;
+    uint64 bytes = (uint64)info.width * info.height * info.depth * texture.bytes_per_pixel;
+    if (info.type == TextureType::CubeMap)
+    {
+      bytes *= 6;
+    }
+    return (mipmaps) ? bytes + bytes / 3 : bytes;
+  }
+
+  template<class T, class B>
+  static bool GrowPool(paged_array<T>* pool, paged_array<B>* back_end_pool, gpu::FreeList* free_list, const char* name)
+  {
+    size_t size = pool->size();
+    if (size >= pool->max_size())
+    {
+      VXR_LOG(VXR_DEBUG_LEVEL_ERROR, "[ERROR]: [GPU] Could not grow %s pool, all %u ids are in use.\n", name, (uint32)size);
+      return false;
+    }
+    // Backend slots and instances must exist before the free list hands the new ids out.
+    back_end_pool->grow(size + pool->page_size());
+    pool->grow(size + pool->page_size());
+    free_list->grow((uint32)pool->size());
+    VXR_LOG(VXR_DEBUG_LEVEL_DEBUG, "[DEBUG]: [GPU] Grew %s pool to %u.\n", name, (uint32)pool->size());
+    return true;
+  }
+
+  bool RenderContext::grow(gpu::Resource::Type::Enum type)
+  {
+    std::lock_guard<std::mutex> lock(grow_mx_);
+    switch (type)
+    {
+    case gpu::Resource::Type::Buffer:
+      return !free_buffers_.empty() || GrowPool(&buffers_, &back_end_->buffers, &free_buffers_, "buffer");
+    case gpu::Resource::Type::Texture:
+      return !free_textures_.empty() || GrowPool(&textures_, &back_end_->textures, &free_textures_, "texture");
+    case gpu::Resource::Type::Material:
+      return !free_materials_.empty() || GrowPool(&materials_, &back_end_->materials, &free_materials_, "material");
+    case gpu::Resource::Type::Framebuffer:
+      return !free_framebuffers_.empty() || GrowPool(&framebuffers_, &back_end_->framebuffers, &free_framebuffers_, "framebuffer");
+    default:
+      return false;
+    }
   }
 
 // ----------------------------------------------------------------------------------------
@@ -0,0 +1,234 @@
+// ----------------------------------------------------------------------------------------
+// MIT License
+// 
+// Copyright(c) 2018 Vctor vila
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// ----------------------------------------------------------------------------------------
+
+#include "../../include/graphics/retained_display_list.h"
+#include "../../include/graphics/dl_command.h"
+#include "../../include/graphics/render_context.h"
+
+namespace vxr
+{
+
+  RetainedDisplayList::RetainedDisplayList()
+  {
+    set_name("Retained Display List");
+  }
+
+  RetainedDisplayList::~RetainedDisplayList()
+  {
+  }
+
+  DisplayList& RetainedDisplayList::record(uint64 key)
+  {
+    // Frames in flight keep their own reference to the previous recording. If there is none left
+    // the commands can be safely reused.
+    if (!commands_ || commands_.use_count() > 1)
+    {
+      commands_ = std::make_shared<DisplayList>();
+    }
+    commands_->reset();
+    resources_.clear();
+    key_ = key;
+    recording_ = true;
+    finished_ = false;
+    return *commands_;
+  }
+
+  bool RetainedDisplayList::finish()
+  {
+    if (!recording_)
+    {
+      VXR_LOG(VXR_DEBUG_LEVEL_ERROR, "[ERROR]: [GPU] Finishing a retained display list that is not being recorded.\n");
+      return false;
+    }
+    recording_ = false;
+
+    track(*commands_);
+    finished_ = true;
+    if (!valid())
+    {
+      VXR_LOG(VXR_DEBUG_LEVEL_ERROR, "[ERROR]: [GPU] Retained display list references invalid resources.\n");
+      finished_ = false;
+      return false;
+    }
+    return true;
+  }
+
+  bool RetainedDisplayList::valid() const
+  {
+    if (!finished_)
+    {
+      return false;
+    }
+
+    for (const gpu::Resource& r : resources_)
+    {
+      bool resource_valid = false;
+      switch (r.type)
+      {
+      case gpu::Resource::Type::Buffer:      resource_valid = RenderContext::CheckValidResource(r.id, &r.ctx->buffers_); break;
+      case gpu::Resource::Type::Texture:     resource_valid = RenderContext::CheckValidResource(r.id, &r.ctx->textures_); break;
+      case gpu::Resource::Type::Material:    resource_valid = RenderContext::CheckValidResource(r.id, &r.ctx->materials_); break;
+      case gpu::Resource::Type::Framebuffer: resource_valid = RenderContext::CheckValidResource(r.id, &r.ctx->framebuffers_); break;
+      default: break;
+      }
+
+      if (!resource_valid)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void RetainedDisplayList::invalidate()
+  {
+    finished_ = false;
+  }
+
+  uint64 RetainedDisplayList::key() const
+  {
+    return key_;
+  }
+
+  uint32 RetainedDisplayList::num_commands() const
+  {
+    return (commands_) ? commands_->num_commands() : 0;
+  }
+
+  void RetainedDisplayList::track(const gpu::Resource& resource)
+  {
+    // Unset handles (e.g. unused texture units) are not referenced by the commands.
+    if (!resource.ctx)
+    {
+      return;
+    }
+
+    for (const gpu::Resource& r : resources_)
+    {
+      if (r.ctx == resource.ctx && r.id == resource.id && r.type == resource.type)
+      {
+        return;
+      }
+    }
+    resources_.push_back(resource);
+  }
+
+  void RetainedDisplayList::track(const DisplayList& commands)
+  {
+    for (uint32 p = 0; p < commands.num_pages_used_; ++p)
+    {
+      const DisplayList::Page* page = commands.pages_[p].get();
+      uint32 offset = 0;
+      while (offset < page->used)
+      {
+        DisplayList::Command* c = (DisplayList::Command*)(page->data + offset);
+        switch (c->type)
+        {
+        case DisplayList::Command::SetupView:
+        {
+          track(((DisplayList::SetupViewData*)c->payload())->framebuffer);
+          break;
+        }
+        case DisplayList::Command::FillBuffer:
+        {
+          track(((DisplayList::FillBufferData*)c->payload())->buffer);
+          break;
+        }
+        case DisplayList::Command::FillTexture:
+        {
+          track(((DisplayList::FillTextureData*)c->payload())->texture);
+          break;
+        }
+        case DisplayList::Command::SetupMaterial:
+        {
+          DisplayList::SetupMaterialData* d = (DisplayList::SetupMaterialData*)c->payload();
+          track(d->material);
+          for (uint32 i = 0; i < kMaxTextureUnits; ++i) track(d->texture[i]);
+          for (uint32 i = 0; i < kMaxVertexAttribs; ++i) track(d->buffer[i]);
+          for (uint32 i = 0; i < kMaxUniformBuffers + 1; ++i) track(d->uniform_buffer[i]);
+          break;
+        }
+        case DisplayList::Command::Render:
+        {
+          track(((DisplayList::RenderData*)c->payload())->index_buffer);
+          break;
+        }
+        case DisplayList::Command::Retained:
+        {
+          track(*((DisplayList::RetainedData*)c->payload())->commands);
+          break;
+        }
+        default:
+          break;
+        }
+        offset += c->size;
+      }
+    }
+  }
+
+  // FNV-1a, over the 32-bit words of the resource ids and state.
+  static uint64 HashWords(uint64 hash, const uint32* words, uint32 count)
+  {
+    for (uint32 i = 0; i < count; ++i)
+    {
+      hash ^= words[i];
+      hash *= 1099511628211ull;
+    }
+    return hash;
+  }
+
+  // Same over the characters of a string, so that equal names stored at different addresses match.
+  static uint64 HashString(uint64 hash, const char* string)
+  {
+    const uint32 kNull = 0xFFFFFFFF, kEnd = 0;
+    if (!string)
+    {
+      return HashWords(hash, &kNull, 1);
+    }
+    for (; *string; ++string)
+    {
+      hash ^= (uint8)*string;
+      hash *= 1099511628211ull;
+    }
+    return HashWords(hash, &kEnd, 1);
+  }
+
+  uint64 RetainedDisplayList::Key(const DisplayList::SetupMaterialData& material, const DisplayList::RenderData& render)
+  {
+    uint64 hash = 14695981039346656037ull;
+    hash = HashWords(hash, &material.material.id, 1);
+    for (uint32 i = 0; i < kMaxTextureUnits; ++i) hash = HashWords(hash, &material.texture[i].id, 1);
+    for (uint32 i = 0; i < kMaxVertexAttribs; ++i) hash = HashWords(hash, &material.buffer[i].id, 1);
+    for (uint32 i = 0; i < kMaxUniformBuffers + 1; ++i) hash = HashWords(hash, &material.uniform_buffer[i].id, 1);
+    hash = HashWords(hash, material.uniform_buffer_offset, kMaxUniformBuffers + 1);
+    hash = HashWords(hash, material.uniform_buffer_size, kMaxUniformBuffers + 1);
+    for (uint32 i = 0; i < kMaxUniformBuffers + 1; ++i) hash = HashString(hash, material.uniform_block[i]);
+    hash = HashWords(hash, (const uint32*)&material.scissor, sizeof(material.scissor) / sizeof(uint32));
+    hash = HashWords(hash, (const uint32*)&material.model_matrix, sizeof(material.model_matrix) / sizeof(uint32));
+
+    const uint32 draw[] = { render.index_buffer.id, render.offset, render.count, render.instances, (uint32)render.type, render.base_vertex };
+    return HashWords(hash, draw, sizeof(draw) / sizeof(uint32));
+  }
+
+}
\ No newline at end of file
@@ -31,8 +31,10 @@
 #  include "../graphics/backend/opengl/gl_backend.h"
 #elif defined (VXR_DX11)
 #  include "../graphics/backend/dx11/dx11_backend.h"
+#elif defined (VXR_NULL)
+#  include "../graphics/backend/null/null_backend.h"
 #else
-#  error Backend must be defined on GENie.lua (e.g. try parameters --gl OR --dx11).
+#  error Backend must be defined on GENie.lua (e.g. try parameters --gl, --dx11 OR --null).
 #endif
 
 namespace vxr
@@ -49,6 +51,7 @@ namespace vxr
 
   Texture::~Texture()
   {
+    Engine::ref().gpu()->destroyTexture(gpu_.tex);
     for (uint32 i = 0; i < 6; ++i)
     {
       if (data_[i])
@@ -26,6 +26,7 @@
 #include "../../../include/engine/engine.h"
 #include "../../../include/engine/gpu.h"
 #include "../../../include/components/camera.h"
+#include "../../../include/components/renderer.h"
 #include "../../../include/core/scene.h"
 #include "../../../include/graphics/composer.h"
 
@@ -82,6 +83,7 @@ namespace vxr
     //Log.AddLog("asdasdasdasd");
     static bool show_editor = true;
     static bool show_statistics = false;
+    static bool show_gpu_memory = false;
     static bool show_texture_viewer = false;
 
     ref_ptr<Camera> cam = Engine::ref().camera()->main();
@@ -114,6 +116,7 @@ namespace vxr
       if (ImGui::BeginMenu("View"))
       {
         ImGui::MenuItem("Show Statistics", "", &show_statistics);
+        ImGui::MenuItem("Show GPU Memory", "", &show_gpu_memory);
         ImGui::MenuItem("Show Editor", "", &show_editor);
         ImGui::MenuItem("Show Texture Viewer", "", &show_texture_viewer);
 
@@ -140,6 +143,7 @@ namespace vxr
       ImGui::PopStyleVar();
 
       if (show_statistics) Statistics(&show_statistics, !show_editor);
+      if (show_gpu_memory) GPUMemory(&show_gpu_memory, !show_editor);
       if (show_texture_viewer) TextureViewer(&show_texture_viewer, !show_editor);
       return;
     }
@@ -205,6 +209,7 @@ namespace vxr
     ImGui::End();
 
     if (show_statistics) Statistics(&show_statistics, !show_editor);
+    if (show_gpu_memory) GPUMemory(&show_gpu_memory, !show_editor);
     if (show_texture_viewer) TextureViewer(&show_texture_viewer, !show_editor);
   }
 
@@ -224,14 +229,74 @@ namespace vxr
     {
       ImGui::Text("GPU data:");
       ref_ptr<GPU> gpu = Engine::ref().gpu();
-      ImGui::Text("Buffers:         %d / %d", gpu->num_used_buffers(), gpu->num_buffers());
-      ImGui::Text("Textures:        %d / %d", gpu->num_used_textures(), gpu->num_textures());
-      ImGui::Text("Materials:       %d / %d", gpu->num_used_materials(), gpu->num_materials());
-      ImGui::Text("Framebuffers:    %d / %d", gpu->num_used_framebuffers(), gpu->num_framebuffers());
+      ImGui::Text("Buffers:         %d / %d (peak %d)", gpu->num_used_buffers(), gpu->num_buffers(), gpu->peak_used_buffers());
+      ImGui::Text("Textures:        %d / %d (peak %d)", gpu->num_used_textures(), gpu->num_textures(), gpu->peak_used_textures());
+      ImGui::Text("Materials:       %d / %d (peak %d)", gpu->num_used_materials(), gpu->num_materials(), gpu->peak_used_materials());
+      ImGui::Text("Framebuffers:    %d / %d (peak %d)", gpu->num_used_framebuffers(), gpu->num_framebuffers(), gpu->peak_used_framebuffers());
+      ImGui::Separator();
+      ref_ptr<System::Renderer> renderer = Engine::ref().renderer();
+      ImGui::Text("Renderers:       %d visible, %d culled, %d occluded", renderer->num_visible(), renderer->num_culled(), renderer->num_occluded());
+      ImGui::Separator();
+      ImGui::Text("Frames in flight: %d", gpu->frames_in_flight());
+      ImGui::Text("Logic wait:      %.3f ms (%d stalls)", gpu->logic_wait_ms(), gpu->logic_stalls());
+      ImGui::Text("Render wait:     %.3f ms (%d stalls)", gpu->render_wait_ms(), gpu->render_stalls());
     }
     ImGui::End();
   }
   
+  static float ToMB(uint64 bytes)
+  {
+    return (float)bytes / (1024.0f * 1024.0f);
+  }
+
+  void ui::GPUMemory(bool *open, bool fullscreen)
+  {
+    static const int kHistorySize = 120;
+    static float upload_history[kHistorySize] = {};
+    static int history_offset = 0;
+    static uint32 last_frame = 0;
+
+    GPU::Stats s = Engine::ref().gpu()->stats();
+    uint64 upload_bytes = s.frame.fill_buffer_bytes + s.frame.fill_texture_bytes;
+    if (s.frames != last_frame)
+    {
+      upload_history[history_offset] = (float)upload_bytes / 1024.0f;
+      history_offset = (history_offset + 1) % kHistorySize;
+      last_frame = s.frames;
+    }
+
+    if (fullscreen)
+    {
+      ImGui::SetNextWindowPos(ImVec2(ImGui::GetIO().DisplaySize.x * 0.008f, ImGui::GetIO().DisplaySize.y * 0.3f), ImGuiCond_Always);
+    }
+    else
+    {
+      ImGui::SetNextWindowPos(ImVec2(ImGui::GetIO().DisplaySize.x * 0.172f, ImGui::GetIO().DisplaySize.y * 0.36f), ImGuiCond_Always);
+    }
+
+    ImGui::SetNextWindowBgAlpha(0.3f); // Transparent background
+    if (ImGui::Begin("GPU Memory", open, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav))
+    {
+      ImGui::Text("GPU memory:      current / peak");
+      ImGui::Text("Buffers:         %.2f / %.2f MB", ToMB(s.buffers.bytes), ToMB(s.buffers.peak_bytes));
+      ImGui::Text("Textures:        %.2f / %.2f MB", ToMB(s.textures.bytes), ToMB(s.textures.peak_bytes));
+      ImGui::Separator();
+      ImGui::Text("Last frame commands:");
+      ImGui::Text("Setup views:     %d", s.frame.setup_views);
+      ImGui::Text("Clears:          %d", s.frame.clears);
+      ImGui::Text("Setup materials: %d", s.frame.setup_materials);
+      ImGui::Text("Renders:         %d", s.frame.renders);
+      ImGui::Text("Retained:        %d (%d commands)", s.frame.retained_lists, s.frame.retained_commands);
+      ImGui::Text("Fill buffers:    %d (%.2f KB)", s.frame.fill_buffers, (float)s.frame.fill_buffer_bytes / 1024.0f);
+      ImGui::Text("Fill textures:   %d (%.2f KB)", s.frame.fill_textures, (float)s.frame.fill_texture_bytes / 1024.0f);
+      ImGui::Text("Transient:       %.2f KB", (float)s.frame.transient_bytes / 1024.0f);
+      ImGui::Separator();
+      ImGui::Text("Uploads:         %.2f KB (peak %.2f KB)", (float)upload_bytes / 1024.0f, (float)s.peak_frame_upload_bytes / 1024.0f);
+      ImGui::PlotHistogram("##Uploads", upload_history, kHistorySize, history_offset, "KB / frame", 0.0f, FLT_MAX, ImVec2(260, 60));
+    }
+    ImGui::End();
+  }
+
   void ui::TextureViewer(bool *open, bool fullscreen)
   { 
     if (fullscreen)
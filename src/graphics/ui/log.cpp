@@ -32,7 +32,7 @@ namespace vxr
     buffer.clear(); line_offsets.clear(); last_msg = "";
   }
 
-  void ui::EditorLog::AddLog(const char* fmt, ...) IM_FMTARGS(2)
+  void ui::EditorLog::AddLog(const char* fmt, ...)
   {
     if (fmt == last_msg.c_str())
     {
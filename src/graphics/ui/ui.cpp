@@ -29,8 +29,10 @@
 #  include "../backend/opengl/gl_imgui.h"
 #elif defined (VXR_DX11)
 #  include "../backend/dx11/dx11_imgui.h"
+#elif defined (VXR_NULL)
+#  include "../backend/null/null_imgui.h"
 #else
-#  error Backend must be defined on GENie.lua (e.g. try parameters --gl OR --dx11).
+#  error Backend must be defined on GENie.lua (e.g. try parameters --gl, --dx11 OR --null).
 #endif
 
 namespace vxr
@@ -31,8 +31,10 @@
 #  include "backend/opengl/gl_window.h"
 #elif defined (VXR_DX11)
 #  include "backend/dx11/dx11_window.h"
+#elif defined (VXR_NULL)
+#  include "backend/null/null_window.h"
 #else
-#  error Backend must be defined on GENie.lua (e.g. --gl OR --dx11).
+#  error Backend must be defined on GENie.lua (e.g. --gl, --dx11 OR --null).
 #endif
 
 namespace vxr 
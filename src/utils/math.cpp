@@ -24,6 +24,10 @@
 
 #include "../../include/utils/math.h"
 
+#if VXR_SIMD
+#  include <xmmintrin.h>
+#endif
+
 namespace vxr 
 {
   vec3 Math::lerp(vec3 a, vec3 b, float alpha) 
@@ -52,4 +56,104 @@ namespace vxr
     return ((value - a) / (b - a));
   }
 
+  static void ComposeTransform(const vec3& p, const quat& q, const vec3& s, const mat4& parent, mat4* out)
+  {
+    // Rotation matrix of the quaternion with its rows scaled (scale * rotate), column by column.
+    const float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    const float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    const float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+    const vec3 c0 = s * vec3(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy));
+    const vec3 c1 = s * vec3(2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx));
+    const vec3 c2 = s * vec3(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy));
+
+    const vec3 p0 = vec3(parent[0]), p1 = vec3(parent[1]), p2 = vec3(parent[2]), p3 = vec3(parent[3]);
+    (*out)[0] = vec4(p0 * c0.x + p1 * c0.y + p2 * c0.z, 0.0f);
+    (*out)[1] = vec4(p0 * c1.x + p1 * c1.y + p2 * c1.z, 0.0f);
+    (*out)[2] = vec4(p0 * c2.x + p1 * c2.y + p2 * c2.z, 0.0f);
+    (*out)[3] = vec4(p0 * p.x + p1 * p.y + p2 * p.z + p3, 1.0f);
+  }
+
+  void Math::composeTransforms(uint32 count, const vec3* positions, const quat* rotations, const vec3* scales, const mat4* const* parents, mat4* out, bool simd)
+  {
+    uint32 i = 0;
+#if VXR_SIMD
+    // Four transformations per iteration, one per lane. Parent columns are transposed in and the result
+    // columns transposed out.
+    const __m128 one = _mm_set1_ps(1.0f), two = _mm_set1_ps(2.0f);
+    for (; simd && i + 4 <= count; i += 4)
+    {
+      const vec3* p = &positions[i];
+      const quat* q = &rotations[i];
+      const vec3* s = &scales[i];
+      const __m128 qx = _mm_setr_ps(q[0].x, q[1].x, q[2].x, q[3].x);
+      const __m128 qy = _mm_setr_ps(q[0].y, q[1].y, q[2].y, q[3].y);
+      const __m128 qz = _mm_setr_ps(q[0].z, q[1].z, q[2].z, q[3].z);
+      const __m128 qw = _mm_setr_ps(q[0].w, q[1].w, q[2].w, q[3].w);
+      const __m128 sx = _mm_setr_ps(s[0].x, s[1].x, s[2].x, s[3].x);
+      const __m128 sy = _mm_setr_ps(s[0].y, s[1].y, s[2].y, s[3].y);
+      const __m128 sz = _mm_setr_ps(s[0].z, s[1].z, s[2].z, s[3].z);
+
+      const __m128 xx = _mm_mul_ps(qx, qx), yy = _mm_mul_ps(qy, qy), zz = _mm_mul_ps(qz, qz);
+      const __m128 xy = _mm_mul_ps(qx, qy), xz = _mm_mul_ps(qx, qz), yz = _mm_mul_ps(qy, qz);
+      const __m128 wx = _mm_mul_ps(qw, qx), wy = _mm_mul_ps(qw, qy), wz = _mm_mul_ps(qw, qz);
+
+      // local[c][r], columns 0..2 of the scaled rotation and the translation.
+      __m128 local[4][3];
+      local[0][0] = _mm_mul_ps(sx, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))));
+      local[0][1] = _mm_mul_ps(sy, _mm_mul_ps(two, _mm_add_ps(xy, wz)));
+      local[0][2] = _mm_mul_ps(sz, _mm_mul_ps(two, _mm_sub_ps(xz, wy)));
+      local[1][0] = _mm_mul_ps(sx, _mm_mul_ps(two, _mm_sub_ps(xy, wz)));
+      local[1][1] = _mm_mul_ps(sy, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))));
+      local[1][2] = _mm_mul_ps(sz, _mm_mul_ps(two, _mm_add_ps(yz, wx)));
+      local[2][0] = _mm_mul_ps(sx, _mm_mul_ps(two, _mm_add_ps(xz, wy)));
+      local[2][1] = _mm_mul_ps(sy, _mm_mul_ps(two, _mm_sub_ps(yz, wx)));
+      local[2][2] = _mm_mul_ps(sz, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))));
+      local[3][0] = _mm_setr_ps(p[0].x, p[1].x, p[2].x, p[3].x);
+      local[3][1] = _mm_setr_ps(p[0].y, p[1].y, p[2].y, p[3].y);
+      local[3][2] = _mm_setr_ps(p[0].z, p[1].z, p[2].z, p[3].z);
+
+      // parent[c][r] of the four lanes.
+      __m128 parent[4][4];
+      for (uint32 c = 0; c < 4; ++c)
+      {
+        parent[c][0] = _mm_loadu_ps(&(*parents[i + 0])[c][0]);
+        parent[c][1] = _mm_loadu_ps(&(*parents[i + 1])[c][0]);
+        parent[c][2] = _mm_loadu_ps(&(*parents[i + 2])[c][0]);
+        parent[c][3] = _mm_loadu_ps(&(*parents[i + 3])[c][0]);
+        _MM_TRANSPOSE4_PS(parent[c][0], parent[c][1], parent[c][2], parent[c][3]);
+      }
+
+      __m128 world[4][4];
+      for (uint32 c = 0; c < 4; ++c)
+      {
+        for (uint32 r = 0; r < 3; ++r)
+        {
+          world[c][r] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(parent[0][r], local[c][0]), _mm_mul_ps(parent[1][r], local[c][1])), _mm_mul_ps(parent[2][r], local[c][2]));
+        }
+        world[c][3] = _mm_setzero_ps();
+      }
+      for (uint32 r = 0; r < 3; ++r)
+      {
+        world[3][r] = _mm_add_ps(world[3][r], parent[3][r]);
+      }
+      world[3][3] = one;
+
+      for (uint32 c = 0; c < 4; ++c)
+      {
+        _MM_TRANSPOSE4_PS(world[c][0], world[c][1], world[c][2], world[c][3]);
+        _mm_storeu_ps(&out[i + 0][c][0], world[c][0]);
+        _mm_storeu_ps(&out[i + 1][c][0], world[c][1]);
+        _mm_storeu_ps(&out[i + 2][c][0], world[c][2]);
+        _mm_storeu_ps(&out[i + 3][c][0], world[c][3]);
+      }
+    }
+#else
+    (void)simd;
+#endif
+    for (; i < count; ++i)
+    {
+      ComposeTransform(positions[i], rotations[i], scales[i], *parents[i], &out[i]);
+    }
+  }
+
 }
\ No newline at end of file
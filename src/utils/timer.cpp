@@ -24,6 +24,10 @@
 
 #include "../../include/utils/timer.h"
 
+#ifndef _WIN32
+#  include <chrono>
+#endif
+
 namespace vxr 
 {
 
@@ -31,6 +35,8 @@ namespace vxr
   {
 #ifdef _WIN32
 		return (unsigned)timeGetTime();
+#else
+    return (unsigned)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
 #endif
 	}
 